@@ -437,15 +437,12 @@ while {$repcnt} {
                 dbgclear
 
                 set genlist {}
-                set newdiffs {}
+                set newdiffs [C$sc decode-matrix $ker]
                 for {set i 0} {$i<$ngen} {incr i} {
-                    set vct [lindex [matrix extract row $ker $i] 0]
-                    lappend newdiffs [C$sc decode $vct]
                     lappend genlist $id
                     incr id
                 }
 
-                unset -nocomplain vct ;# to save memory
                 unset -nocomplain ker ;# to save memory
 
                 dbgadd { "approximate diffs = $newdiffs" }
@@ -559,7 +556,7 @@ while {$repcnt} {
 
                 # introduce new generators:
 
-                set gl [C$sn cget -genlist]
+                set gl {}
                 foreach id $genlist df $newdiffs {
                     lappend gl [list $id $ideg $edeg 0]
                     eval d$sn set \[list 0 0 0 $id\] \$df
@@ -568,7 +565,7 @@ while {$repcnt} {
                         puts $ch "# gen $id diff = [llength $df] summands"
                     }
                 }
-                eval C$sn configure -genlist \$gl
+                C$sn addgens $gl
 
             }
         }
@@ -109,7 +109,7 @@ matrix *matrix_ortho(primeInfo *pi, matrix *inp, matrix **urb,
 
             /* go through all other rows and normalize */
             v2.data = v1.data + spr; aux += spr;
-            v3.data = un->data + i * uspr;
+            v3.data = un->data + (size_t) i * uspr;
             v4.data = v3.data + uspr;
             for (j=i+1; j<inp->rows;
                  j++, v2.data+=spr, v4.data+=uspr, aux+=spr) {
@@ -214,7 +214,7 @@ matrix *matrix_lift(primeInfo *pi, matrix *inp, matrix *lft, matrix *bas,
             if (entry<0) entry += prime;
             negcoeff = coeff = pi->inverse[entry];
             coeff = prime-coeff;
-	    v3.data = un->data + i * uspr;
+	    v3.data = un->data + (size_t) i * uspr;
 	    if(NULL == bas) {
 	      /* go through all other rows and normalize */
 	      v2.data = v1.data + spr; aux += spr;
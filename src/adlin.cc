@@ -110,7 +110,7 @@ matrix *matrix_ortho(primeInfo *pi, matrix *inp, matrix **urb,
             coeff = prime-coeff; coeff %= prime;
             /* go through all other rows and normalize */
             v2.data = v1.data + spr; aux += spr;
-            v3.data = un->data + i * uspr;
+            v3.data = un->data + (size_t) i * uspr;
             v4.data = v3.data + uspr;
             for (j=i+1; j<inp->rows;
                  j++, v2.data+=spr, v4.data+=uspr, aux+=spr)
@@ -202,7 +202,7 @@ matrix *matrix_lift(primeInfo *pi, matrix *inp, matrix *lft, matrix *bas,
             pos = aux - v1.data;
             negcoeff = coeff = pi->inverse[(unsigned) auxval];
             coeff = prime-coeff; coeff %= prime;
-	    v3.data = un->data + i * uspr;
+	    v3.data = un->data + (size_t) i * uspr;
 	    if(NULL == bas) {
 	      /* go through all other rows and normalize */
 	      v2.data = v1.data + spr; aux += spr;
@@ -335,3 +335,150 @@ int matrix_quotient(primeInfo *pi, matrix *ker, matrix *im,
 }
 
 #endif /* USESSE2 */
+
+/**** MATRIX MULTIPLICATION *************************************************/
+
+#include "parallel.h"
+#include <limits.h>
+#include <string.h>
+
+/* The product is computed in tiles of MULTROWS rows and MULTCOLS columns
+ * of the result, which are accumulated in 32 bit integers. The factors
+ * are first reduced to unsigned bytes, and a tile is only reduced mod p
+ * when the next MULTDEPTH rows of the second factor might overflow it. */
+
+#ifndef MULTROWS
+#  define MULTROWS  32
+#endif
+#ifndef MULTCOLS
+#  define MULTCOLS  512
+#endif
+#ifndef MULTDEPTH
+#  define MULTDEPTH 256
+#endif
+
+/* products with fewer multiplications than this are not threaded */
+#ifndef MULTPARMIN
+#  define MULTPARMIN (1 << 24)
+#endif
+
+/* acc[j] += a * b[j] for j < n */
+static void mult_row_kernel(unsigned *acc, const unsigned char *b, unsigned a, int n) {
+#ifdef USESSE2
+    __m128i s = _mm_set1_epi16((short) a), z = _mm_setzero_si128();
+    for (; n >= 16; n -= 16, b += 16, acc += 16) {
+        __m128i x  = _mm_loadu_si128((const __m128i *) b);
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(x, z), s);
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(x, z), s);
+        __m128i *ac = (__m128i *) acc;
+        _mm_storeu_si128(ac,     _mm_add_epi32(_mm_loadu_si128(ac),     _mm_unpacklo_epi16(lo, z)));
+        _mm_storeu_si128(ac + 1, _mm_add_epi32(_mm_loadu_si128(ac + 1), _mm_unpackhi_epi16(lo, z)));
+        _mm_storeu_si128(ac + 2, _mm_add_epi32(_mm_loadu_si128(ac + 2), _mm_unpacklo_epi16(hi, z)));
+        _mm_storeu_si128(ac + 3, _mm_add_epi32(_mm_loadu_si128(ac + 3), _mm_unpackhi_epi16(hi, z)));
+    }
+#endif
+    while (n--) *acc++ += a * *b++;
+}
+
+typedef struct {
+    const unsigned char *a, *b;  /* reduced factors */
+    matrix *res;
+    int rows, inb, cols, prime;
+    int maxterms;                /* terms that fit into an accumulator */
+    int njobs, failed;
+} multjob;
+
+static void mult_job(void *cd, int job) {
+    multjob *mj = (multjob *) cd;
+    int nblk = (mj->rows + MULTROWS - 1) / MULTROWS;
+    int blk, i, j, k, k0, j0, cw, nr, terms;
+    unsigned *acc = (unsigned *) mallox(sizeof(unsigned) * MULTROWS * MULTCOLS);
+
+    if (NULL == acc) {
+        mj->failed = 1;
+        return;
+    }
+
+    /* the row blocks are dealt out round robin */
+    for (blk=job; blk<nblk; blk+=mj->njobs) {
+        nr = MIN(MULTROWS, mj->rows - blk * MULTROWS);
+        for (j0=0; j0<mj->cols; j0+=MULTCOLS) {
+            cw = MIN(MULTCOLS, mj->cols - j0);
+            memset(acc, 0, sizeof(unsigned) * MULTROWS * MULTCOLS);
+            for (terms=0, k0=0; k0<mj->inb; k0+=MULTDEPTH) {
+                int kd = MIN(MULTDEPTH, mj->inb - k0);
+                if (terms + kd > mj->maxterms) {
+                    for (j=0; j<nr*MULTCOLS; j++) acc[j] %= mj->prime;
+                    terms = 1;
+                }
+                terms += kd;
+                for (i=0; i<nr; i++) {
+                    const unsigned char *ar = mj->a + (size_t) (blk * MULTROWS + i) * mj->inb;
+                    for (k=k0; k<k0+kd; k++)
+                        if (ar[k])
+                            mult_row_kernel(acc + i * MULTCOLS,
+                                            mj->b + (size_t) k * mj->cols + j0, ar[k], cw);
+                }
+            }
+            for (i=0; i<nr; i++) {
+                cint *dst = MATROW(mj->res, blk * MULTROWS + i) + j0;
+                for (j=0; j<cw; j++) dst[j] = (cint) (acc[i * MULTCOLS + j] % mj->prime);
+            }
+        }
+    }
+
+    freex(acc);
+}
+
+/* copy of the entries of m, reduced to 0,...,prime-1 */
+static unsigned char *mult_reduced_copy(matrix *m, int prime) {
+    unsigned char *res = (unsigned char *) mallox((size_t) m->rows * m->cols + 1), *dst;
+    int i, j;
+    if (NULL == res) return NULL;
+    for (dst=res, i=0; i<m->rows; i++) {
+        const cint *src = MATROW(m, i);
+        for (j=0; j<m->cols; j++) {
+            int v = src[j] % prime;
+            *dst++ = (unsigned char) ((v < 0) ? (v + prime) : v);
+        }
+    }
+    return res;
+}
+
+int matrix_multiply(matrix *res, matrix *a, matrix *b, cint prime) {
+    multjob mj;
+    unsigned maxprod;
+
+    if ((a->cols != b->rows) || (res->rows != a->rows) || (res->cols != b->cols)
+        || (prime < 2))
+        return FAILIMPOSSIBLE;
+
+    matrix_clear(res);
+    if ((0 == a->rows) || (0 == a->cols) || (0 == b->cols)) return SUCCESS;
+
+    mj.a = mult_reduced_copy(a, prime);
+    mj.b = mult_reduced_copy(b, prime);
+    if ((NULL == mj.a) || (NULL == mj.b)) {
+        if (NULL != mj.a) freex((void *) mj.a);
+        if (NULL != mj.b) freex((void *) mj.b);
+        return FAILMEM;
+    }
+
+    mj.res = res;
+    mj.rows = a->rows; mj.inb = a->cols; mj.cols = b->cols;
+    mj.prime = prime;
+    maxprod = (prime - 1) * (prime - 1);
+    mj.maxterms = (int) MIN((UINT_MAX - prime) / maxprod, (unsigned) INT_MAX);
+    mj.failed = 0;
+
+    mj.njobs = 1;
+    if ((double) a->rows * a->cols * b->cols >= MULTPARMIN)
+        mj.njobs = MIN(parallelThreads(), (a->rows + MULTROWS - 1) / MULTROWS);
+
+    parallelRun(mj.njobs, mult_job, &mj);
+
+    freex((void *) mj.a);
+    freex((void *) mj.b);
+
+    return mj.failed ? FAILMEM : SUCCESS;
+}
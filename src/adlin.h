@@ -38,4 +38,8 @@ int matrix_quotient(primeInfo *pi, matrix *ker, matrix *im,
              Tcl_Interp *ip, const char *progvar, int pmsk,
 		    int *LINALG_INTERRUPT_VARIABLE);
 
+/* res = a * b mod prime; the entries of a and b need not be reduced.
+ * Large products are computed by several threads. */
+int matrix_multiply(matrix *res, matrix *a, matrix *b, cint prime);
+
 #endif
@@ -38,6 +38,7 @@
 #define FAILMEM         2  /* out of memory */
 #define FAILIMPOSSIBLE  3  /* operation not possible */
 #define FAILUNTRUE      4  /* another word for "no" */
+#define FAILOVERFLOW    5  /* numeric overflow */
 
 #define DONT_USE_TCL_ALLOC 
 #define DONT_USE_VERB_ALLOC
@@ -0,0 +1,615 @@
+/*
+ * Asymptotically fast dense linear algebra for the prime 2
+ *
+ * Copyright (C) 2005-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#define DENSE2C
+
+#include <string.h>
+#include "dense2.h"
+#include "parallel.h"
+
+/* products whose dimensions (rows, resp. entries per row) are all at
+ * least D2STRASSENMIN are split by Strassen-Winograd */
+#ifndef D2STRASSENMIN
+#  define D2STRASSENMIN 4096
+#endif
+
+/* blocks of at most D2BASEROWS rows are eliminated row by row */
+#ifndef D2BASEROWS
+#  define D2BASEROWS 256
+#endif
+
+/* products with fewer than D2PARMIN words of the result times words
+ * of the inner dimension are not threaded */
+#ifndef D2PARMIN
+#  define D2PARMIN (1 << 20)
+#endif
+
+/* the Four Russians multiplication uses D2TABLES tables of 256 rows at
+ * once, each of at most D2TABWORDS words; together they should fit into
+ * the level 2 cache */
+#define D2TABLES   4
+#ifndef D2TABWORDS
+#  define D2TABWORDS 32
+#endif
+
+/* d2ExtractCols gathers the bits directly unless there are more than
+ * D2GATHERRUNS runs of consecutive columns per word of source and
+ * result; then the columns are taken as rows of the transpose */
+#ifndef D2GATHERRUNS
+#  define D2GATHERRUNS 5
+#endif
+
+#define D2ROW(w,r)  ((w)->data + (size_t) (r) * (w)->stride)
+#define D2BIT(v,c)  (((v)[(c) / BITSPERWORD] >> ((c) % BITSPERWORD)) & 1)
+
+void d2Window(m2win *w, mat2 *m) {
+    w->data = m->data;
+    w->rows = m->rows;
+    w->words = w->stride = m->ipr;
+}
+
+void d2SubWindow(m2win *res, const m2win *w, int r0, int nr, int w0, int nw) {
+    m2word *data = D2ROW(w, r0) + w0;
+    res->stride = w->stride;
+    res->data = data;
+    res->rows = nr;
+    res->words = nw;
+}
+
+/**** scratch buffers and row operations ************************************/
+
+static int d2Alloc(m2win *w, int rows, int words) {
+    w->rows = rows;
+    w->words = w->stride = words;
+    w->data = (m2word *) callox((size_t) rows * words + 1, sizeof(m2word));
+    return (NULL == w->data) ? FAILMEM : SUCCESS;
+}
+
+static void d2Free(m2win *w) {
+    if (NULL != w->data) freex(w->data);
+    w->data = NULL;
+}
+
+static void d2Clear(m2win *w) {
+    int r;
+    for (r=0; r<w->rows; r++)
+        memset(D2ROW(w, r), 0, sizeof(m2word) * w->words);
+}
+
+static void d2Copy(m2win *dst, const m2win *src) {
+    int r;
+    for (r=0; r<dst->rows; r++)
+        memcpy(D2ROW(dst, r), D2ROW(src, r), sizeof(m2word) * dst->words);
+}
+
+static void d2Xor(m2win *dst, const m2win *src) {
+    int r;
+    for (r=0; r<dst->rows; r++)
+        vector_add2(D2ROW(dst, r), D2ROW(src, r), dst->words);
+}
+
+/* the len <= 64 bits of v starting at column p */
+static m2word d2Bits(const m2word *v, int p, int len) {
+    int o = p % BITSPERWORD;
+    m2word x = v[p / BITSPERWORD] >> o;
+    if (o + len > (int) BITSPERWORD) x |= v[p / BITSPERWORD + 1] << (BITSPERWORD - o);
+    if (len < (int) BITSPERWORD) x &= (((m2word) 1) << len) - 1;
+    return x;
+}
+
+/* number of runs that d2Gather splits pos[0],...,pos[k-1] into */
+static int d2GatherRuns(const int *pos, int k) {
+    int j, n = 0;
+    for (j=0; j<k; j++)
+        if ((0 == j) || (0 == j % BITSPERWORD)
+            || ((pos[j] < 0) ? (pos[j-1] >= 0) : (pos[j] != pos[j-1] + 1)))
+            n++;
+    return n;
+}
+
+/* Runs of consecutive columns are moved up to a word at a time. */
+int d2Gather(m2win *dst, const m2win *src, const int *pos, int k) {
+    int r, j, n, nrun, *run;
+    d2Clear(dst);
+    if (NULL == (run = (int *) mallox(sizeof(int) * 2 * (k + 1)))) return FAILMEM;
+    for (nrun=0, j=0; j<k; j+=n) {
+        /* a run must not leave its destination word */
+        for (n=1; (j+n < k) && ((j+n) % BITSPERWORD)
+                 && ((pos[j] < 0) ? (pos[j+n] < 0) : (pos[j+n] == pos[j] + n)); n++) ;
+        if (pos[j] < 0) continue;
+        run[2*nrun] = j; run[2*nrun+1] = n; nrun++;
+    }
+    for (r=0; r<src->rows; r++) {
+        const m2word *s = D2ROW(src, r);
+        m2word *d = D2ROW(dst, r);
+        for (j=0; j<nrun; j++) {
+            int t = run[2*j];
+            d[t / BITSPERWORD] |= d2Bits(s, pos[t], run[2*j+1]) << (t % BITSPERWORD);
+        }
+    }
+    freex(run);
+    return SUCCESS;
+}
+
+/**** multiplication ********************************************************/
+
+/* Method of Four Russians: for every byte of the rows of A we tabulate
+ * the 256 combinations of the corresponding eight rows of B, in Gray
+ * code order, and add the table row that the byte selects. Four bytes
+ * are handled in one pass over C. */
+static int d2MulBase(m2win *C, const m2win *A, const m2win *B, int accumulate) {
+    int m = A->rows, nw = C->words, nbits = MIN(B->rows, A->words * (int) BITSPERWORD);
+    int c0, cw, g, t, i, r, tsz;
+    m2word *tab;
+
+    if (!accumulate) d2Clear(C);
+    if ((0 == m) || (0 == nw)) return SUCCESS;
+
+    if (m < 16) {
+        /* too few rows to pay for the tables */
+        for (r=0; r<m; r++) {
+            const m2word *a = D2ROW(A, r);
+            for (i=0; i<nbits; i++)
+                if (D2BIT(a, i)) vector_add2(D2ROW(C, r), D2ROW(B, i), nw);
+        }
+        return SUCCESS;
+    }
+
+    tsz = 256 * MIN(nw, D2TABWORDS);
+    tab = (m2word *) mallox(sizeof(m2word) * D2TABLES * tsz);
+    if (NULL == tab) return FAILMEM;
+
+    for (c0=0; c0<nw; c0+=D2TABWORDS) {
+        cw = MIN(D2TABWORDS, nw - c0);
+        for (g=0; 8*g<nbits; g+=D2TABLES) {
+            /* table t holds the combinations of rows 8(g+t),...,8(g+t)+7;
+             * missing rows count as zero */
+            for (t=0; t<D2TABLES; t++) {
+                m2word *tt = tab + t * tsz;
+                memset(tt, 0, sizeof(m2word) * cw);
+                for (i=1; i<256; i++) {
+                    unsigned c = i ^ (i >> 1), p = (i - 1) ^ ((i - 1) >> 1);
+                    int b = 8 * (g + t) + __builtin_ctz(c ^ p);
+                    m2word *tc = tt + c * cw, *tp = tt + p * cw;
+                    memcpy(tc, tp, sizeof(m2word) * cw);
+                    if (b < nbits) vector_add2(tc, D2ROW(B, b) + c0, cw);
+                }
+            }
+            /* the D2TABLES bytes starting at byte g lie in one word */
+            for (r=0; r<m; r++) {
+                unsigned x = (unsigned) (D2ROW(A, r)[g / 8] >> (8 * (g % 8)));
+                if (0 == x) continue;
+                vector_add2x4(D2ROW(C, r) + c0,
+                              tab + 0 * tsz + ((x      ) & 0xff) * cw,
+                              tab + 1 * tsz + ((x >>  8) & 0xff) * cw,
+                              tab + 2 * tsz + ((x >> 16) & 0xff) * cw,
+                              tab + 3 * tsz + ((x >> 24) & 0xff) * cw, cw);
+            }
+        }
+    }
+
+    freex(tab);
+    return SUCCESS;
+}
+
+static int d2UseBase(const m2win *A, const m2win *B) {
+    return (A->rows < D2STRASSENMIN)
+        || (MIN(B->rows, A->words * (int) BITSPERWORD) < D2STRASSENMIN)
+        || (B->words * (int) BITSPERWORD < D2STRASSENMIN);
+}
+
+/* C = A * B */
+static int d2Mul(m2win *C, const m2win *A, const m2win *B) {
+    int m = A->rows, kw = A->words, nw = B->words;
+    int m2, k2, n2, mh, kh, nh, rc = SUCCESS;
+    m2win a11, a12, a21, a22, b11, b12, b21, b22, c11, c12, c21, c22;
+    m2win X, Xs, Xp, Y, t1, t2, t3;
+
+    if (d2UseBase(A, B)) return d2MulBase(C, A, B, 0);
+
+    /* Strassen-Winograd on the largest part with even dimensions;
+     * an odd last row or word column of C and the words of A beyond
+     * the last even number of full words of B are peeled off and done
+     * by the base case */
+    m2 = m & ~1; k2 = MIN(kw, B->rows / (int) BITSPERWORD) & ~1; n2 = nw & ~1;
+    mh = m2 / 2; kh = k2 / 2; nh = n2 / 2;
+
+    if (m2 < m) {
+        d2SubWindow(&t1, A, m2, 1, 0, kw);
+        d2SubWindow(&t2, C, m2, 1, 0, nw);
+        if (SUCCESS != (rc = d2MulBase(&t2, &t1, B, 0))) return rc;
+    }
+    if (n2 < nw) {
+        d2SubWindow(&t1, A, 0, m2, 0, kw);
+        d2SubWindow(&t2, B, 0, B->rows, n2, 1);
+        d2SubWindow(&t3, C, 0, m2, n2, 1);
+        if (SUCCESS != (rc = d2MulBase(&t3, &t1, &t2, 0))) return rc;
+    }
+
+    if (SUCCESS != d2Alloc(&X, mh, MAX(kh, nh))) return FAILMEM;
+    if (SUCCESS != d2Alloc(&Y, kh * BITSPERWORD, nh)) {
+        d2Free(&X);
+        return FAILMEM;
+    }
+    Xs = X; Xs.words = Xs.stride = kh;
+    Xp = X; Xp.words = Xp.stride = nh;
+
+    d2SubWindow(&a11, A, 0, mh, 0, kh);
+    d2SubWindow(&a12, A, 0, mh, kh, kh);
+    d2SubWindow(&a21, A, mh, mh, 0, kh);
+    d2SubWindow(&a22, A, mh, mh, kh, kh);
+    d2SubWindow(&b11, B, 0, kh * BITSPERWORD, 0, nh);
+    d2SubWindow(&b12, B, 0, kh * BITSPERWORD, nh, nh);
+    d2SubWindow(&b21, B, kh * BITSPERWORD, kh * BITSPERWORD, 0, nh);
+    d2SubWindow(&b22, B, kh * BITSPERWORD, kh * BITSPERWORD, nh, nh);
+    d2SubWindow(&c11, C, 0, mh, 0, nh);
+    d2SubWindow(&c12, C, 0, mh, nh, nh);
+    d2SubWindow(&c21, C, mh, mh, 0, nh);
+    d2SubWindow(&c22, C, mh, mh, nh, nh);
+
+    /* the schedule with two temporaries of Boyer, Dumas, Pernet and Zhou */
+    do {
+        d2Copy(&Xs, &a11); d2Xor(&Xs, &a21);                    /* S3 */
+        d2Copy(&Y, &b22);  d2Xor(&Y, &b12);                     /* T3 */
+        if (SUCCESS != (rc = d2Mul(&c21, &Xs, &Y))) break;      /* P7 */
+        d2Copy(&Xs, &a21); d2Xor(&Xs, &a22);                    /* S1 */
+        d2Copy(&Y, &b12);  d2Xor(&Y, &b11);                     /* T1 */
+        if (SUCCESS != (rc = d2Mul(&c22, &Xs, &Y))) break;      /* P5 */
+        d2Xor(&Y, &b22);                                        /* T2 */
+        d2Xor(&Xs, &a11);                                       /* S2 */
+        if (SUCCESS != (rc = d2Mul(&c12, &Xs, &Y))) break;      /* P6 */
+        d2Xor(&Xs, &a12);                                       /* S4 */
+        if (SUCCESS != (rc = d2Mul(&c11, &Xs, &b22))) break;    /* P3 */
+        if (SUCCESS != (rc = d2Mul(&Xp, &a11, &b11))) break;    /* P1 */
+        d2Xor(&c12, &Xp);                                       /* U2 = P1 + P6 */
+        d2Xor(&c21, &c12);                                      /* U3 = U2 + P7 */
+        d2Xor(&c12, &c22);                                      /* U4 = U2 + P5 */
+        d2Xor(&c22, &c21);                                      /* U7 = U3 + P5 */
+        d2Xor(&c12, &c11);                                      /* U5 = U4 + P3 */
+        d2Xor(&Y, &b21);                                        /* T4 */
+        if (SUCCESS != (rc = d2Mul(&c11, &a22, &Y))) break;     /* P4 */
+        d2Xor(&c21, &c11);                                      /* U6 = U3 + P4 */
+        if (SUCCESS != (rc = d2Mul(&c11, &a12, &b21))) break;   /* P2 */
+        d2Xor(&c11, &Xp);                                       /* U1 = P1 + P2 */
+    } while (0);
+
+    d2Free(&X);
+    d2Free(&Y);
+
+    if ((SUCCESS == rc) && (k2 < kw)) {
+        d2SubWindow(&t1, A, 0, m2, k2, kw - k2);
+        d2SubWindow(&t2, B, k2 * BITSPERWORD,
+                    MIN(B->rows, kw * (int) BITSPERWORD) - k2 * BITSPERWORD, 0, n2);
+        d2SubWindow(&t3, C, 0, m2, 0, n2);
+        rc = d2MulBase(&t3, &t1, &t2, 1);
+    }
+
+    return rc;
+}
+
+int d2Multiply(m2win *C, const m2win *A, const m2win *B, int accumulate) {
+    m2win tmp;
+    int rc;
+    if (!accumulate) return d2Mul(C, A, B);
+    if (d2UseBase(A, B)) return d2MulBase(C, A, B, 1);
+    if (SUCCESS != d2Alloc(&tmp, C->rows, C->words)) return FAILMEM;
+    if (SUCCESS == (rc = d2Mul(&tmp, A, B)))
+        d2Xor(C, &tmp);
+    d2Free(&tmp);
+    return rc;
+}
+
+typedef struct {
+    m2win       *C;
+    const m2win *A, *B;
+    int          accumulate, njobs, rc;
+} d2mulJob;
+
+/* job j computes the j-th slab of rows of the product */
+static void d2MulPart(void *cd, int job) {
+    d2mulJob *mj = (d2mulJob *) cd;
+    int r0 = (int) ((long long) mj->A->rows * job / mj->njobs);
+    int r1 = (int) ((long long) mj->A->rows * (job + 1) / mj->njobs);
+    m2win a, c;
+    int rc;
+    d2SubWindow(&a, mj->A, r0, r1 - r0, 0, mj->A->words);
+    d2SubWindow(&c, mj->C, r0, r1 - r0, 0, mj->C->words);
+    if (SUCCESS != (rc = d2Multiply(&c, &a, mj->B, mj->accumulate))) mj->rc = rc;
+}
+
+int d2MultiplyParallel(m2win *C, const m2win *A, const m2win *B, int accumulate) {
+    d2mulJob mj;
+
+    mj.njobs = 1;
+    if ((long long) C->rows * C->words * A->words >= D2PARMIN)
+        mj.njobs = MIN(parallelThreads(), MAX(1, C->rows / 64));
+
+    if (1 == mj.njobs) return d2Multiply(C, A, B, accumulate);
+
+    mj.C = C; mj.A = A; mj.B = B;
+    mj.accumulate = accumulate;
+    mj.rc = SUCCESS;
+    parallelRun(mj.njobs, d2MulPart, &mj);
+
+    return mj.rc;
+}
+
+/**** elimination ***********************************************************/
+
+/* Make the rows lo,...,hi-1 of R vanish in each other's pivot columns,
+ * where row t has the pivot pos[t] (or none if pos[t] < 0) and vanishes
+ * in the pivot columns of the rows before it. Row operations are
+ * repeated on C. The number hi-lo must be a multiple of BITSPERWORD. */
+static int d2ReduceUpper(m2win *R, m2win *C, const int *pos, int lo, int hi) {
+    m2win T, top, bot;
+    int s, t, mid, rc;
+
+    if ((hi - lo <= D2BASEROWS) || (hi - lo < 2 * (int) BITSPERWORD)) {
+        for (t=hi-1; t>=lo; t--) {
+            if (pos[t] < 0) continue;
+            for (s=lo; s<t; s++)
+                if (D2BIT(D2ROW(R, s), pos[t])) {
+                    vector_add2(D2ROW(R, s), D2ROW(R, t), R->words);
+                    if (NULL != C)
+                        vector_add2(D2ROW(C, s), D2ROW(C, t), C->words);
+                }
+        }
+        return SUCCESS;
+    }
+
+    /* first the lower rows, then clear their pivot columns in the upper ones */
+    mid = hi - BITSPERWORD * ((hi - lo) / (2 * BITSPERWORD));
+
+    if (SUCCESS != (rc = d2ReduceUpper(R, C, pos, mid, hi))) return rc;
+
+    if (SUCCESS != d2Alloc(&T, mid - lo, (hi - mid) / BITSPERWORD)) return FAILMEM;
+    d2SubWindow(&top, R, lo, mid - lo, 0, R->words);
+    d2SubWindow(&bot, R, mid, hi - mid, 0, R->words);
+    if (SUCCESS == (rc = d2Gather(&T, &top, pos + mid, hi - mid)))
+        rc = d2MultiplyParallel(&top, &T, &bot, 1);
+    if ((SUCCESS == rc) && (NULL != C)) {
+        d2SubWindow(&top, C, lo, mid - lo, 0, C->words);
+        d2SubWindow(&bot, C, mid, hi - mid, 0, C->words);
+        rc = d2MultiplyParallel(&top, &T, &bot, 1);
+    }
+    d2Free(&T);
+    if (SUCCESS != rc) return rc;
+
+    return d2ReduceUpper(R, C, pos, lo, mid);
+}
+
+/* The plain elimination adds pivot row t to a row x if x has a one in
+ * column pivpos[t] at that time. For pivot rows in staircase form this
+ * amounts to adding x[P] * U^-1 * R, where R are the pivot rows, x[P]
+ * the entries of x in the pivot columns and U = R[P]. We compute U^-1 * R
+ * by clearing the pivot columns of R recursively, and then add the
+ * product x[P] * (U^-1 * R) for all rows x of tgt at once. */
+int d2Reduce(m2win *tgt, m2win *tcomp, const m2win *src, const m2win *scomp,
+             int cwords, const int *pivrow, const int *pivpos, int k) {
+    int kp = ((k + BITSPERWORD - 1) / BITSPERWORD) * BITSPERWORD;
+    int t, rc, *pos;
+    m2win R, C, T, w;
+
+    if ((0 == k) || (0 == tgt->rows)) return SUCCESS;
+    if (NULL == tcomp) cwords = 0;
+
+    if (NULL == (pos = (int *) mallox(sizeof(int) * kp))) return FAILMEM;
+    if (SUCCESS != d2Alloc(&R, kp, src->words)) {
+        freex(pos);
+        return FAILMEM;
+    }
+    if (SUCCESS != d2Alloc(&C, kp, cwords)) {
+        d2Free(&R); freex(pos);
+        return FAILMEM;
+    }
+
+    for (t=0; t<kp; t++) {
+        pos[t] = (t < k) ? pivpos[t] : -1;
+        if (t >= k) continue;
+        memcpy(D2ROW(&R, t), D2ROW(src, pivrow[t]), sizeof(m2word) * src->words);
+        if (cwords)
+            memcpy(D2ROW(&C, t), D2ROW(scomp, pivrow[t]), sizeof(m2word) * cwords);
+    }
+
+    rc = d2ReduceUpper(&R, cwords ? &C : NULL, pos, 0, kp);
+
+    if ((SUCCESS == rc) && (SUCCESS == (rc = d2Alloc(&T, tgt->rows, kp / BITSPERWORD)))) {
+        d2SubWindow(&w, tgt, 0, tgt->rows, 0, src->words);
+        if (SUCCESS == (rc = d2Gather(&T, tgt, pos, kp)))
+            rc = d2MultiplyParallel(&w, &T, &R, 1);
+        if ((SUCCESS == rc) && cwords) {
+            d2SubWindow(&w, tcomp, 0, tcomp->rows, 0, cwords);
+            rc = d2MultiplyParallel(&w, &T, &C, 1);
+        }
+        d2Free(&T);
+    }
+
+    d2Free(&C);
+    d2Free(&R);
+    freex(pos);
+
+    return rc;
+}
+
+typedef struct {
+    m2win     *a, *c;
+    int        ctri;
+    int       *pivrow, *pivpos, npiv;
+    d2rowFunc *cb;
+    void      *cd;
+} d2elim;
+
+/* number of words of companion row i that can be nonzero */
+static int d2CompWords(d2elim *x, int i) {
+    if (NULL == x->c) return 0;
+    if (!x->ctri) return x->c->words;
+    return MIN(x->c->words, i / (int) BITSPERWORD + 1);
+}
+
+static int d2EliminateBase(d2elim *x, int lo, int hi) {
+    int i, j, piv, off, cw, wds = x->a->words;
+    m2word msk, *v;
+
+    for (i=lo; i<hi; i++) {
+        if ((NULL != x->cb) && x->cb(x->cd, i)) return FAILIMPOSSIBLE;
+        v = D2ROW(x->a, i);
+        if (0 > (piv = vector_firstbit2(v, wds))) continue;
+        x->pivrow[x->npiv] = i;
+        x->pivpos[x->npiv++] = piv;
+        off = piv / BITSPERWORD;
+        msk = ((m2word) 1) << (piv % BITSPERWORD);
+        cw = d2CompWords(x, i);
+        for (j=i+1; j<hi; j++) {
+            m2word *w = D2ROW(x->a, j);
+            if (0 == (w[off] & msk)) continue;
+            /* v vanishes before word off */
+            vector_add2(w + off, v + off, wds - off);
+            if (cw) vector_add2(D2ROW(x->c, j), D2ROW(x->c, i), cw);
+        }
+    }
+
+    return SUCCESS;
+}
+
+static int d2EliminateRec(d2elim *x, int lo, int hi) {
+    int mid, first, rc, cw;
+    m2win tgt, tcomp;
+
+    if (hi - lo <= D2BASEROWS) return d2EliminateBase(x, lo, hi);
+
+    mid = lo + (hi - lo) / 2;
+    first = x->npiv;
+
+    if (SUCCESS != (rc = d2EliminateRec(x, lo, mid))) return rc;
+
+    if (x->npiv > first) {
+        /* reduce the lower half by the pivots of the upper one */
+        cw = d2CompWords(x, mid - 1);
+        d2SubWindow(&tgt, x->a, mid, hi - mid, 0, x->a->words);
+        if (cw) d2SubWindow(&tcomp, x->c, mid, hi - mid, 0, cw);
+        rc = d2Reduce(&tgt, cw ? &tcomp : NULL, x->a, x->c, cw,
+                      x->pivrow + first, x->pivpos + first, x->npiv - first);
+        if (SUCCESS != rc) return rc;
+    }
+
+    return d2EliminateRec(x, mid, hi);
+}
+
+int d2Eliminate(m2win *a, m2win *c, int ctri, int *pivrow, int *pivpos,
+                int *npiv, d2rowFunc *cb, void *cd) {
+    d2elim x;
+    int rc;
+    x.a = a; x.c = c; x.ctri = ctri;
+    x.pivrow = pivrow; x.pivpos = pivpos; x.npiv = 0;
+    x.cb = cb; x.cd = cd;
+    rc = d2EliminateRec(&x, 0, a->rows);
+    *npiv = x.npiv;
+    return rc;
+}
+
+int d2Staircase(const m2win *a, int *pivrow, int *pivpos, int *npiv) {
+    m2word *seen;
+    int i, j, piv, rc = SUCCESS;
+
+    *npiv = 0;
+    if (NULL == (seen = (m2word *) callox(a->words + 1, sizeof(m2word))))
+        return FAILMEM;
+
+    for (i=0; (SUCCESS == rc) && (i<a->rows); i++) {
+        const m2word *v = D2ROW(a, i);
+        for (j=0; j<a->words; j++)
+            if (0 != (v[j] & seen[j])) {
+                rc = FAILUNTRUE;
+                break;
+            }
+        if ((SUCCESS != rc) || (0 > (piv = vector_firstbit2(v, a->words))))
+            continue;
+        pivrow[*npiv] = i;
+        pivpos[(*npiv)++] = piv;
+        seen[piv / BITSPERWORD] |= ((m2word) 1) << (piv % BITSPERWORD);
+    }
+
+    freex(seen);
+    return rc;
+}
+
+/**** transposition *********************************************************/
+
+/* a[i] bit j <-> a[j] bit i: the off-diagonal blocks of size 32, 16, ...
+ * of all diagonal blocks are swapped in turn */
+static void d2Transpose64(m2word *a) {
+    m2word m = 0x00000000ffffffffULL, t;
+    int j, k;
+    for (j=32; j; j>>=1, m^=m<<j)
+        for (k=0; k<64; k=((k|j)+1)&~j) {
+            t = ((a[k] >> j) ^ a[k|j]) & m;
+            a[k] ^= t << j;
+            a[k|j] ^= t;
+        }
+}
+
+/* transpose the 64x64 blocks in the block rows r0,...,r1-1 and block
+ * columns w0,...,w1-1 of src; halving the longer side makes this cache
+ * oblivious */
+static void d2TransposeRec(m2win *dst, const m2win *src,
+                           int r0, int r1, int w0, int w1) {
+    m2word blk[64];
+    int i, r, c;
+    if ((r1 - r0 > 1) && (r1 - r0 >= w1 - w0)) {
+        d2TransposeRec(dst, src, r0, (r0 + r1) / 2, w0, w1);
+        d2TransposeRec(dst, src, (r0 + r1) / 2, r1, w0, w1);
+        return;
+    }
+    if (w1 - w0 > 1) {
+        d2TransposeRec(dst, src, r0, r1, w0, (w0 + w1) / 2);
+        d2TransposeRec(dst, src, r0, r1, (w0 + w1) / 2, w1);
+        return;
+    }
+    for (i=0; i<64; i++)
+        blk[i] = ((r = 64 * r0 + i) < src->rows) ? D2ROW(src, r)[w0] : 0;
+    d2Transpose64(blk);
+    for (i=0; i<64; i++)
+        if ((c = 64 * w0 + i) < dst->rows) D2ROW(dst, c)[r0] = blk[i];
+}
+
+void d2Transpose(m2win *dst, const m2win *src) {
+    int rb = (src->rows + BITSPERWORD - 1) / BITSPERWORD;
+    int wb = (dst->rows + BITSPERWORD - 1) / BITSPERWORD;
+    if ((0 == rb) || (0 == wb)) return;
+    d2TransposeRec(dst, src, 0, rb, 0, MIN(wb, src->words));
+}
+
+int d2ExtractCols(m2win *dst, const m2win *src, const int *pos, int k) {
+    m2win T, U;
+    int i;
+
+    if (d2GatherRuns(pos, k)
+        <= D2GATHERRUNS * (long long) (src->words + (k + BITSPERWORD - 1) / BITSPERWORD))
+        return d2Gather(dst, src, pos, k);
+
+    /* select rows of the transpose, and transpose back */
+    if (SUCCESS != d2Alloc(&T, src->words * BITSPERWORD,
+                           (src->rows + BITSPERWORD - 1) / BITSPERWORD))
+        return FAILMEM;
+    if (SUCCESS != d2Alloc(&U, k, T.words)) {
+        d2Free(&T);
+        return FAILMEM;
+    }
+    d2Transpose(&T, src);
+    for (i=0; i<k; i++)
+        if (pos[i] >= 0)
+            memcpy(D2ROW(&U, i), D2ROW(&T, pos[i]), sizeof(m2word) * T.words);
+    d2Clear(dst);
+    d2Transpose(dst, &U);
+    d2Free(&U);
+    d2Free(&T);
+    return SUCCESS;
+}
@@ -0,0 +1,85 @@
+/*
+ * Asymptotically fast dense linear algebra for the prime 2
+ *
+ * Copyright (C) 2005-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#ifndef DENSE2_DEF
+#define DENSE2_DEF
+
+#include "linwrp.h"
+
+/* A window into the rows of a mat2 or of a scratch buffer: "rows" rows
+ * of "words" words each, consecutive rows being "stride" words apart.
+ * Windows always start at a word boundary. */
+typedef struct {
+    m2word *data;
+    int     rows, words, stride;
+} m2win;
+
+/* the window of all of m */
+void d2Window(m2win *w, mat2 *m);
+
+/* the rows r0,...,r0+nr-1 and words w0,...,w0+nw-1 of w */
+void d2SubWindow(m2win *res, const m2win *w, int r0, int nr, int w0, int nw);
+
+/* C = A * B, or C += A * B if accumulate is set. Column i of A is
+ * multiplied with row i of B; columns of A without a row of B are
+ * ignored. Large products use Strassen-Winograd, the base case is the
+ * Method of Four Russians. */
+int d2Multiply(m2win *C, const m2win *A, const m2win *B, int accumulate);
+
+/* like d2Multiply, but large products are split into slabs of rows
+ * that are computed by parallelThreads() threads */
+int d2MultiplyParallel(m2win *C, const m2win *A, const m2win *B, int accumulate);
+
+/* dst = the entries of src in the columns pos[0],...,pos[k-1], bit by
+ * bit; negative positions give zero columns. dst must have room for
+ * k columns and src->rows rows. */
+int d2Gather(m2win *dst, const m2win *src, const int *pos, int k);
+
+/* dst = the transpose of src, as far as it fits into dst; the words of
+ * dst beyond the first (src->rows + 63) / 64 are not touched */
+void d2Transpose(m2win *dst, const m2win *src);
+
+/* like d2Gather, but many scattered columns are extracted as rows of
+ * the transpose */
+int d2ExtractCols(m2win *dst, const m2win *src, const int *pos, int k);
+
+/* called by d2Eliminate for every row it is about to process; a nonzero
+ * return value stops the elimination */
+typedef int (d2rowFunc)(void *cd, int row);
+
+/* Reduce the rows of a, one after the other, by the pivots of the rows
+ * before them; the pivot of a row is its first nonzero column. Every row
+ * operation is repeated on the companion c (if c is not NULL). If ctri
+ * is set, row i of c is assumed to vanish beyond column i.
+ *
+ * The result is the same as that of the plain row by row elimination,
+ * but the work is done recursively in blocks, via d2Reduce.
+ *
+ * The pivot rows and columns are stored in pivrow[], pivpos[], which
+ * must have room for a->rows entries, and their number in *npiv.
+ * Returns FAILIMPOSSIBLE if interrupted by the callback. */
+int d2Eliminate(m2win *a, m2win *c, int ctri, int *pivrow, int *pivpos,
+                int *npiv, d2rowFunc *cb, void *cd);
+
+/* Reduce the rows of tgt by the k pivot rows pivrow[] of src with pivot
+ * columns pivpos[], in this order, and repeat the row operations on the
+ * first cwords words of tcomp and scomp (if tcomp is not NULL).
+ * Each pivot row must vanish in the pivot columns of its predecessors;
+ * d2Eliminate produces such rows, d2Staircase checks for them. */
+int d2Reduce(m2win *tgt, m2win *tcomp, const m2win *src, const m2win *scomp,
+             int cwords, const int *pivrow, const int *pivpos, int k);
+
+/* Find the pivots of a and check that every row vanishes in the pivot
+ * columns of the rows above it; zero rows are skipped. Returns
+ * FAILUNTRUE if this is not the case. */
+int d2Staircase(const m2win *a, int *pivrow, int *pivpos, int *npiv);
+
+#endif
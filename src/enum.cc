@@ -14,6 +14,7 @@
 #define ENUMC
 
 #include <string.h>
+#include <tcl.h>
 #include "enum.h"
 
 enumerator *enmCreate(void) {
@@ -30,6 +31,9 @@ void *copymem(void *src, size_t sz) {
     return res;
 }
 
+static void enmShareSeqtab(enumerator *en, seqtabs *st);
+static void enmReleaseSeqtab(seqtabs *st);
+
 enumerator *enmCopy(enumerator *src) {
     enumerator *en;
     int i;
@@ -46,17 +50,23 @@ enumerator *enmCopy(enumerator *src) {
 
     en->efflist = NULL;
     en->seqoff = NULL;
+    en->effidx = NULL;
+    en->sigtab = NULL;
 
     /* now make private copies of these arrays */
     en->genList = (int *) copymem(src->genList, 4 * sizeof(int) * src->numgens);
 
-    for (i=NALG+1;i--;) {
-        en->dimtab[i] = (int *) copymem(src->dimtab[i], sizeof(int) * src->tablen);
-        en->seqtab[i] = (int *) copymem(src->seqtab[i], sizeof(int) * src->tablen);
-    }
+    /* the tables are shared */
+    en->tabs = NULL;
+    if (NULL != src->tabs)
+        enmShareSeqtab(en, src->tabs);
 
     en->efflist = (effgen *) copymem(src->efflist, src->efflen * sizeof(effgen));
-    en->seqoff = (int *) copymem(src->seqoff, src->efflen * sizeof(int));
+    en->effalloc = (NULL != en->efflist) ? src->efflen : 0;
+    en->seqoff = (seqint *) copymem(src->seqoff, src->efflen * sizeof(seqint));
+    if (NULL != src->effidx)
+        en->effidx = (int *) copymem(src->effidx, (src->effmsk + 1) * sizeof(int));
+    en->sigtab = (sigentry *) copymem(src->sigtab, src->siglen * sizeof(sigentry));
 
     return en;
 }
@@ -65,10 +75,17 @@ enumerator *enmCopy(enumerator *src) {
 
 void enmDestroySeqOff(enumerator *en) {
     FREEPTR(en->seqoff);
+    FREEPTR(en->effidx);
 }
 
 void enmDestroySeqtab(enumerator *en) {
     int i;
+    if (NULL != en->tabs) {
+        enmReleaseSeqtab(en->tabs);
+        en->tabs = NULL;
+        for (i=0;i<NALG+1;i++)
+            en->dimtab[i] = en->seqtab[i] = NULL;
+    }
 #if 0
     printf("enmDestroySeqtab en=%p\n",en);
     for (i=0;i<NALG+1;i++) {
@@ -83,6 +100,11 @@ void enmDestroySeqtab(enumerator *en) {
     enmDestroySeqOff(en);
 }
 
+void enmDestroySigtab(enumerator *en) {
+    FREEPTR(en->sigtab);
+    en->siglen = en->sigdim = 0;
+}
+
 void enmDestroyEffList(enumerator *en) {
     FREEPTR(en->efflist);
     en->effalloc = en->efflen = 0;
@@ -99,6 +121,7 @@ void enmDestroy(enumerator *en) {
     en->pi = NULL;
     enmDestroyGenList(en);
     enmDestroySeqtab(en);
+    enmDestroySigtab(en);
 }
 
 int enmReallocEfflist(enumerator *en, int size) {
@@ -201,6 +224,29 @@ int findExtsForGenerator(enumerator *en, int id, int rideg, int redeg) {
     return SUCCESS;
 }
 
+/* append the effective generators for the generator glp = (id, ideg, edeg,
+ * hdeg); (tideg, tedeg) is the tridegree after the signature correction */
+static int enmAppendEffgensFor(enumerator *en, const int *glp,
+                               int tideg, int tedeg) {
+    int id = glp[0], ideg = glp[1], edeg = glp[2], hdeg = glp[3];
+    int rideg = tideg - ideg, redeg = tedeg - edeg;
+    if (ENLOG) printf("looking at generator with "
+                      "id=%d ideg=%d edeg=%d hdeg=%d\n", id, ideg, edeg, hdeg);
+    if (hdeg != en->hdeg) return SUCCESS;
+    if (en->ispos) {
+        if ((redeg >= 0) && (rideg >= 0)) {
+            if (SUCCESS != findExtsForGenerator(en, id, rideg, redeg))
+                return FAIL;
+        }
+    } else {
+        if ((redeg <= 0) && (rideg <= 0)) {
+            if (SUCCESS != findExtsForGenerator(en, id, -rideg, -redeg))
+                return FAIL;
+        }
+    }
+    return SUCCESS;
+}
+
 /* create list of effective generators for the given tridegree */
 int enmRecreateEfflist(enumerator *en) {
     int i, *glp, tideg, tedeg, thdeg;
@@ -220,24 +266,9 @@ int enmRecreateEfflist(enumerator *en) {
                       en->sigideg, en->sigedeg, tideg, tedeg, thdeg);
 
     /* go through all gens in the genlist and look for appropriate exteriors */
-    for (i=0,glp=en->genList; i<en->numgens; i++,glp+=4) {
-        int id = glp[0], ideg = glp[1], edeg = glp[2], hdeg = glp[3];
-        int rideg = tideg - ideg, redeg = tedeg - edeg;
-        if (ENLOG) printf("looking at generator with "
-                          "id=%d ideg=%d edeg=%d hdeg=%d\n", id, ideg, edeg, hdeg);
-        if (hdeg != en->hdeg) continue;
-        if (en->ispos) {
-            if ((redeg >= 0) && (rideg >= 0)) {
-                if (SUCCESS != findExtsForGenerator(en, id, rideg, redeg))
-                    return FAIL;
-            }
-        } else {
-            if ((redeg <= 0) && (rideg <= 0)) {
-                if (SUCCESS != findExtsForGenerator(en, id, -rideg, -redeg))
-                    return FAIL;
-            }
-        }
-    }
+    for (i=0,glp=en->genList; i<en->numgens; i++,glp+=4)
+        if (SUCCESS != enmAppendEffgensFor(en, glp, tideg, tedeg))
+            return FAIL;
 
     /* realloc to minimal space */
     if (SUCCESS != enmReallocEfflist(en, 0)) {
@@ -255,6 +286,7 @@ int enmSetBasics(enumerator *en, primeInfo *pi,
     int i;
     enmDestroyEffList(en);
     enmDestroySeqtab(en);
+    enmDestroySigtab(en);
     en->pi = pi;
     en->ispos = ispos;
 
@@ -288,6 +320,7 @@ int enmSetSignature(enumerator *en, exmo *sig) {
 
 int enmSetTridegree(enumerator *en, int ideg, int edeg, int hdeg) {
     enmDestroyEffList(en);
+    enmDestroySigtab(en);
     en->ideg = ideg; en->hdeg = hdeg; en->edeg = edeg;
     return SUCCESS;
 }
@@ -295,6 +328,7 @@ int enmSetTridegree(enumerator *en, int ideg, int edeg, int hdeg) {
 int enmSetGenlist(enumerator *en, int *gl, int num) {
     int i;
     enmDestroyGenList(en);
+    enmDestroySigtab(en);
     en->genList = gl;
     en->numgens = num;
     /* find max/min ideg/edeg/hdeg/generator */
@@ -327,14 +361,150 @@ int enmSetGenlist(enumerator *en, int *gl, int num) {
 
 /**** SEQUENCE NUMBERS ******************************************************/
 
+/* The dimtab/seqtab tables only depend on the prime, the algebra, the
+ * profile and the maximal degree, so they are kept in a process wide
+ * cache and shared between all enumerators that use the same values.
+ * Shared tables are never modified; an enumerator that needs different
+ * tables simply drops its reference and looks up (or builds) new ones.
+ * A few unreferenced entries are kept around for later reuse. */
+
+#define SEQCACHEKEEP 8
+
+TCL_DECLARE_MUTEX(seqcacheMutex)
+
+static seqtabs *seqcache = NULL;
+
+static int sameExpExmo(const exmo *a, const exmo *b) {
+    int i;
+    if (a->ext != b->ext) return 0;
+    for (i=NALG;i--;)
+        if (a->r.dat[i] != b->r.dat[i]) return 0;
+    return 1;
+}
+
+static int seqtabMatches(seqtabs *st, int prime,
+                         const exmo *algebra, const exmo *profile) {
+    return (st->prime == prime)
+        && sameExpExmo(&(st->algebra), algebra)
+        && sameExpExmo(&(st->profile), profile);
+}
+
+static void seqtabFree(seqtabs *st) {
+    int i;
+    for (i=0;i<NALG+1;i++) {
+        FREEPTR(st->dimtab[i]);
+        FREEPTR(st->seqtab[i]);
+    }
+    freex(st);
+}
+
+/* remove unreferenced entries that are too small or too old; the caller
+ * must hold the seqcacheMutex */
+static void seqtabPurge(seqtabs *keep) {
+    seqtabs **st = &seqcache, *aux;
+    int unused = 0;
+    while (NULL != (aux = *st)) {
+        if ((0 == aux->refcnt)
+            && ((++unused > SEQCACHEKEEP)
+                || ((aux != keep) && (NULL != keep)
+                    && (aux->tabmaxrideg < keep->tabmaxrideg)
+                    && seqtabMatches(aux, keep->prime,
+                                     &(keep->algebra), &(keep->profile))))) {
+            *st = aux->next;
+            seqtabFree(aux);
+            continue;
+        }
+        st = &(aux->next);
+    }
+}
+
+/* caller must hold the seqcacheMutex */
+static void enmAttachSeqtab(enumerator *en, seqtabs *st) {
+    int i;
+    st->refcnt++;
+    en->tabs = st;
+    for (i=0;i<NALG+1;i++) {
+        en->dimtab[i] = st->dimtab[i];
+        en->seqtab[i] = st->seqtab[i];
+    }
+    memcpy(en->effdeg, st->effdeg, sizeof(st->effdeg));
+    en->tablen = st->tablen;
+    en->tabmaxrideg = st->tabmaxrideg;
+}
+
+static void enmShareSeqtab(enumerator *en, seqtabs *st) {
+    Tcl_MutexLock(&seqcacheMutex);
+    enmAttachSeqtab(en, st);
+    Tcl_MutexUnlock(&seqcacheMutex);
+}
+
+static void enmReleaseSeqtab(seqtabs *st) {
+    Tcl_MutexLock(&seqcacheMutex);
+    if (0 == --(st->refcnt))
+        seqtabPurge(NULL);
+    Tcl_MutexUnlock(&seqcacheMutex);
+}
+
+static int enmBuildSeqtab(enumerator *en);
+
 int enmCreateSeqtab(enumerator *en) {
+    seqtabs *st;
+    int i, rcode = SUCCESS;
+
+    if (NULL == en->pi) return FAILIMPOSSIBLE;
+    enmDestroySeqtab(en);
+
+    Tcl_MutexLock(&seqcacheMutex);
+
+    for (st = seqcache; NULL != st; st = st->next)
+        if ((st->tabmaxrideg >= en->maxrrideg)
+            && seqtabMatches(st, en->pi->prime, &(en->algebra), &(en->profile)))
+            break;
+
+    if (NULL == st) {
+        if (SUCCESS != (rcode = enmBuildSeqtab(en))) {
+            Tcl_MutexUnlock(&seqcacheMutex);
+            return rcode;
+        }
+        if (NULL == (st = (seqtabs *) callox(1, sizeof(seqtabs)))) {
+            Tcl_MutexUnlock(&seqcacheMutex);
+            enmDestroySeqtab(en);
+            return FAILMEM;
+        }
+        st->prime = en->pi->prime;
+        copyExmo(&(st->algebra), &(en->algebra));
+        copyExmo(&(st->profile), &(en->profile));
+        for (i=0;i<NALG+1;i++) {
+            st->dimtab[i] = en->dimtab[i];
+            st->seqtab[i] = en->seqtab[i];
+        }
+        memcpy(st->effdeg, en->effdeg, sizeof(st->effdeg));
+        st->tablen = en->tablen;
+        st->tabmaxrideg = en->tabmaxrideg;
+        st->next = seqcache;
+        seqcache = st;
+    } else if (ENLOG) {
+        printf("reusing dimtab & seqtab for prime %d upto rideg %d\n",
+               st->prime, st->tabmaxrideg);
+    }
+
+    enmAttachSeqtab(en, st);
+    seqtabPurge(st);
+
+    Tcl_MutexUnlock(&seqcacheMutex);
+
+    return rcode;
+}
+
+/* add b >= 0 to a, failing on overflow */
+#define SEQADD(a,b) \
+{ if ((b) > SEQINTMAX - (a)) goto overflow; (a) += (b); }
+
+static int enmBuildSeqtab(enumerator *en) {
     primeInfo *pi = en->pi;
     int reddim, maxdim, i, j, k, n;
     exmo *alg = &(en->algebra), *pro = &(en->profile);
 
-    if (NULL == pi) return FAILIMPOSSIBLE;
-    enmDestroySeqtab(en);
-
     maxdim = 10 + (1 + en->maxrrideg) * en->pi->tpmo;
 
     reddim   = 1 + maxdim / pi->tpmo;
@@ -346,13 +516,13 @@ int enmCreateSeqtab(enumerator *en) {
 
     /* allocate space */
     for (i=NALG+1;i--;)
-        if (NULL == (en->dimtab[i] = (int *) mallox(sizeof(int) * (reddim+1)))) {
+        if (NULL == (en->dimtab[i] = (seqint *) mallox(sizeof(seqint) * (reddim+1)))) {
             enmDestroySeqtab(en);
             return FAILMEM;
         }
 
     for (i=NALG+1;i--;)
-        if (NULL == (en->seqtab[i] = (int *) mallox(sizeof(int) * (reddim+1)))) {
+        if (NULL == (en->seqtab[i] = (seqint *) mallox(sizeof(seqint) * (reddim+1)))) {
             enmDestroySeqtab(en);
             return FAILMEM;
         }
@@ -384,10 +554,11 @@ int enmCreateSeqtab(enumerator *en) {
     /* now dimtab[i] for k[xi_1,...,xi_{i+1}] */
     for (i=1;i<NALG;i++)
         for (j=0;j<reddim;j++) {
-            int sum=0, d = pi->reddegs[i];
+            seqint sum=0;
+            int d = pi->reddegs[i];
             for (k=j/d;k>=0;k--)
                 if ((k<alg->r.dat[i]) && ((k % pro->r.dat[i]) == 0))
-                    sum += en->dimtab[i-1][j-k*d];
+                    SEQADD(sum, en->dimtab[i-1][j-k*d]);
             en->dimtab[i][j] = sum;
         }
 
@@ -399,9 +570,10 @@ int enmCreateSeqtab(enumerator *en) {
      * where d = effective degree */
     for (k=1;k<NALG;k++)
         for (n=0;n<reddim;n++) {
-            int sum=0, d = en->effdeg[k];
+            seqint sum=0;
+            int d = en->effdeg[k];
             for (i=n-d;i>=0;i-=d)
-                sum += en->dimtab[k-1][i];
+                SEQADD(sum, en->dimtab[k-1][i]);
             en->seqtab[k][n] = sum;
         }
 
@@ -412,26 +584,84 @@ int enmCreateSeqtab(enumerator *en) {
         printf("\nbeginning of dimtab:\n");
         for (i=0;i<NALG;i++) {
             printf("  dimtab[%d] (at %p) = ",i,en->dimtab[i]);
-            for (n=0;n<10;n++) printf(" %d",en->dimtab[i][n]);
+            for (n=0;n<10;n++) printf(" %lld",en->dimtab[i][n]);
             printf("...\n");
         }
-        printf("\nbeginning of seqtab: (seqtab[0][0] = %d)\n",en->seqtab[0][0]);
+        printf("\nbeginning of seqtab: (seqtab[0][0] = %lld)\n",en->seqtab[0][0]);
         for (i=1;i<NALG;i++) {
             printf("  seqtab[%d] (at %p) = ",i,en->seqtab[i]);
-            for (n=0;n<10;n++) printf(" %d",en->seqtab[i][n]);
+            for (n=0;n<10;n++) printf(" %lld",en->seqtab[i][n]);
             printf("...\n");
         }
     }
 
     return SUCCESS;
+
+ overflow:
+    enmDestroySeqtab(en);
+    return FAILOVERFLOW;
 }
 
-int algDimension(enumerator *en, int rdim) {
+/* The efflist index is an open addressing hash table of size at least
+ * 4 * efflen. When it is built we try a few multipliers for the hash
+ * function and keep the first one that gives no collisions at all, so
+ * that usually every lookup is a single probe. */
+
+static inline unsigned effHash(enumerator *en, int id, int ext) {
+    unsigned h = ((unsigned) id * 0x9e3779b1u) ^ ((unsigned) ext * en->effmul);
+    return h ^ (h >> 16);
+}
+
+#define effHashTRIES 8
+
+static int enmCreateEffidx(enumerator *en) {
+    static const unsigned muls[effHashTRIES] = {
+        0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu, 0x165667b1u,
+        0xd3a2646cu, 0xfd7046c5u, 0xb55a4f09u, 0x61c88647u };
+    int size, i, t, collisions = 0;
+
+    for (size = 64; size < 4 * en->efflen; size <<= 1) ;
+
+    if (NULL == (en->effidx = (int *) mallox(size * sizeof(int))))
+        return FAILMEM;
+    en->effmsk = size - 1;
+
+    for (t = 0; t < effHashTRIES; t++) {
+        en->effmul = muls[t];
+        for (i = 0; i < size; i++) en->effidx[i] = -1;
+        for (collisions = i = 0; i < en->efflen; i++) {
+            unsigned h = effHash(en, en->efflist[i].id, en->efflist[i].ext);
+            while (en->effidx[h & en->effmsk] >= 0) { h++; collisions++; }
+            en->effidx[h & en->effmsk] = i;
+        }
+        if (0 == collisions) break;
+    }
+
+    if (ENLOG) printf("efflist index: %d entries, size %d, %d collisions\n",
+                      en->efflen, size, collisions);
+
+    return SUCCESS;
+}
+
+/* position of (id, ext) in the efflist, or -1 */
+static int enmFindEffgen(enumerator *en, int id, int ext) {
+    unsigned h = effHash(en, id, ext);
+    int idx;
+    while (0 <= (idx = en->effidx[h & en->effmsk])) {
+        if ((en->efflist[idx].id == id) && (en->efflist[idx].ext == ext))
+            return idx;
+        h++;
+    }
+    return -1;
+}
+
+seqint algDimension(enumerator *en, int rdim) {
     return en->dimtab[NALG-1][rdim];
 }
 
 int enmCreateSeqoff(enumerator *en) {
-    int cnt, i;
+    seqint cnt;
+    int i;
 
     if (NULL == en->efflist)
         if (SUCCESS != (i = enmRecreateEfflist(en)))
@@ -441,28 +671,164 @@ int enmCreateSeqoff(enumerator *en) {
         enmDestroySeqtab(en);
 
     if (NULL == en->seqtab[0])
-        if (SUCCESS != enmCreateSeqtab(en))
-            return FAILMEM;
+        if (SUCCESS != (i = enmCreateSeqtab(en)))
+            return i;
 
-    if (NULL == (en->seqoff = (int *) mallox(en->efflen * sizeof(int))))
+    if (NULL == (en->seqoff = (seqint *) mallox(en->efflen * sizeof(seqint))))
         return FAILMEM;
 
     for (cnt=i=0; i<en->efflen; i++) {
+        seqint dim = algDimension(en, en->efflist[i].rrideg);
         en->seqoff[i] = cnt;
-        if (ENLOG) printf("seqoff (gen %3d ext %3d) = %d\n",
+        if (ENLOG) printf("seqoff (gen %3d ext %3d) = %lld\n",
                           en->efflist[i].id, en->efflist[i].ext, cnt);
-        cnt += algDimension(en, en->efflist[i].rrideg);
+        if (dim > SEQINTMAX - cnt) {
+            enmDestroySeqOff(en);
+            return FAILOVERFLOW;
+        }
+        cnt += dim;
+    }
+
+    en->totaldim = cnt;
+
+    if (SUCCESS != enmCreateEffidx(en)) {
+        enmDestroySeqOff(en);
+        return FAILMEM;
+    }
+
+    return SUCCESS;
+}
+
+/* Append num generators gl (in genList format) to the genlist. Their
+ * internal degrees must be nondecreasing and not smaller than those of
+ * the generators already present. An existing efflist is updated in
+ * place: the new effective generators are merged into the sorted list,
+ * and the sequence number offsets are only recomputed from the first
+ * insertion point on. If that is not possible, we fall back to the lazy
+ * recomputation. */
+int enmAddGens(enumerator *en, const int *gl, int num) {
+    int i, j, k, oldlen, first, tideg, tedeg, *nptr;
+    const int *glp;
+    effgen *nef;
+    seqint *sptr, cnt;
+
+    if (num <= 0) return SUCCESS;
+
+    /* check degrees and ids */
+    for (i=0,glp=gl; i<num; i++,glp+=4) {
+        if (i && (glp[1] < glp[-3])) return FAILIMPOSSIBLE;
+        if (en->numgens && (glp[1] < en->maxideg)) return FAILIMPOSSIBLE;
+        if (en->numgens && (en->mingen <= glp[0]) && (glp[0] <= en->maxgen))
+            for (j=0; j<en->numgens; j++)
+                if (en->genList[4*j] == glp[0]) return FAILIMPOSSIBLE;
+        for (j=0; j<i; j++)
+            if (gl[4*j] == glp[0]) return FAILIMPOSSIBLE;
+    }
+
+    if (NULL == (nptr = (int *) reallox(en->genList,
+                                        (en->numgens + num) * 4 * sizeof(int))))
+        return FAILMEM;
+    en->genList = nptr;
+    memcpy(nptr + 4 * en->numgens, gl, num * 4 * sizeof(int));
+
+    if (0 == en->numgens) {
+        en->maxideg = en->maxedeg = en->maxhdeg = en->maxgen = -999999;
+        en->minideg = en->minedeg = en->minhdeg = en->mingen =  999999;
+    }
+    for (i=0,glp=gl; i<num; i++,glp+=4) {
+        en->maxideg = MAX(en->maxideg, glp[1]);
+        en->minideg = MIN(en->minideg, glp[1]);
+        en->maxedeg = MAX(en->maxedeg, glp[2]);
+        en->minedeg = MIN(en->minedeg, glp[2]);
+        en->maxhdeg = MAX(en->maxhdeg, glp[3]);
+        en->minhdeg = MIN(en->minhdeg, glp[3]);
+        en->maxgen  = MAX(en->maxgen, glp[0]);
+        en->mingen  = MIN(en->mingen, glp[0]);
+    }
+    en->numgens += num;
+    enmDestroySigtab(en);
+
+    if (ENLOG) printf("added %d gens (now %d)\n", num, en->numgens);
+
+    if (NULL == en->efflist) return SUCCESS;
+
+    /* find the new effective generators; the signature info is up to
+     * date since the efflist exists */
+    tideg = en->ideg + (en->ispos ? (-en->sigideg) : en->sigideg);
+    tedeg = en->edeg + (en->ispos ? (-en->sigedeg) : en->sigedeg);
+    oldlen = en->efflen;
+    for (i=0,glp=gl; i<num; i++,glp+=4)
+        if (SUCCESS != enmAppendEffgensFor(en, glp, tideg, tedeg)) {
+            enmDestroyEffList(en);
+            return SUCCESS;
+        }
+
+    if (oldlen == en->efflen) return SUCCESS;
+
+    /* merge them into the sorted list, starting from the end */
+    k = en->efflen - oldlen;
+    if (NULL == (nef = (effgen *) copymem(en->efflist + oldlen, k * sizeof(effgen)))) {
+        enmDestroyEffList(en);
+        return SUCCESS;
+    }
+    qsort(nef, k, sizeof(effgen), compareEffgen);
+    for (i=oldlen, j=k, first=en->efflen; j>0;) {
+        effgen *dst = &(en->efflist[i+j-1]);
+        if ((i > 0) && (compareEffgen(&(en->efflist[i-1]), &(nef[j-1])) > 0)) {
+            *dst = en->efflist[--i];
+        } else {
+            *dst = nef[--j];
+            first = i + j;
+        }
     }
+    freex(nef);
+
+    if (NULL == en->seqoff) return SUCCESS;
 
+    if ((en->maxrrideg > en->tabmaxrideg)
+        || (NULL == (sptr = (seqint *) reallox(en->seqoff,
+                                                en->efflen * sizeof(seqint))))) {
+        enmDestroySeqOff(en);
+        return SUCCESS;
+    }
+    en->seqoff = sptr;
+
+    /* the offsets before the first insertion point remain valid */
+    cnt = 0;
+    if (first > 0)
+        cnt = en->seqoff[first-1] + algDimension(en, en->efflist[first-1].rrideg);
+    for (i=first; i<en->efflen; i++) {
+        seqint dim = algDimension(en, en->efflist[i].rrideg);
+        en->seqoff[i] = cnt;
+        if (dim > SEQINTMAX - cnt) {
+            enmDestroySeqOff(en);
+            return SUCCESS;
+        }
+        cnt += dim;
+    }
     en->totaldim = cnt;
 
+    /* if all entries were appended, they can be added to the index */
+    if ((first == oldlen) && (4 * en->efflen <= en->effmsk + 1)) {
+        for (i=oldlen; i<en->efflen; i++) {
+            unsigned h = effHash(en, en->efflist[i].id, en->efflist[i].ext);
+            while (en->effidx[h & en->effmsk] >= 0) h++;
+            en->effidx[h & en->effmsk] = i;
+        }
+    } else {
+        FREEPTR(en->effidx);
+        if (SUCCESS != enmCreateEffidx(en))
+            enmDestroySeqOff(en);
+    }
+
     return SUCCESS;
 }
 
 /* a seqno version that just uses the algebra pair, not the module */
-int algSeqnoWithRDegree(enumerator *en, exmo *ex, int deg) {
-    int res=0, k, startk;
-    startk = MIN(en->pi->maxpowerXintI,NALG-1);
+seqint algSeqnoWithRDegree(enumerator *en, const exmo *ex, int deg) {
+    seqint res=0;
+    int k, startk;
+    startk = MIN(en->pi->maxpowerXintI,NALG);
     if (ENLOG) printf("algSeqnoWithRDegree deg = %d, startk = %d\n", deg, startk);
     for (k=startk; k--;) {
         int prd, maxdeg, actdeg, exo;
@@ -484,32 +850,332 @@ int algSeqnoWithRDegree(enumerator *en, exmo *ex, int deg) {
     return res;
 }
 
-int SeqnoFromEnum(enumerator *en, exmo *ex) {
-    effgen aux, *res;
-    int cnt, cnt2;
+int enmSeqno(enumerator *en, const exmo *ex, seqint *res) {
+    seqint cnt;
+    int ext, idx, rcode;
+
+    if (NULL == en->seqoff)
+        if (SUCCESS != (rcode = enmCreateSeqoff(en)))
+            return rcode;
+
+    ext = en->ispos ? ex->ext : (-1 - ex->ext);
+    ext ^= (ext & en->profile.ext);
+    if (0 > (idx = enmFindEffgen(en, ex->gen, ext))) return FAILUNTRUE;
+
+    cnt = algSeqnoWithRDegree(en, ex, en->efflist[idx].rrideg);
+    if (cnt < 0) return FAILUNTRUE;
+    *res = en->seqoff[idx] + cnt;
+    return SUCCESS;
+}
+
+seqint SeqnoFromEnum(enumerator *en, exmo *ex) {
+    seqint res;
+    if (SUCCESS != enmSeqno(en, ex, &res)) return -1;
+    return res;
+}
+
+/* Batch version of SeqnoFromEnum. The generator lookup is skipped for
+ * runs of summands with the same generator and exterior part, and the
+ * seqtab lookups are done column by column for a block of summands at
+ * a time, with all loop invariants taken out of the inner loop. */
+
+#define SEQBATCH 256
+
+int SeqnoFromEnumBatch(enumerator *en, const exmo *ex, int num, seqint *seqno) {
+    seqint off[SEQBATCH], cnt[SEQBATCH];
+    int deg[SEQBATCH];
+    int maxd[NALG], prof[NALG], rdeg[NALG];
+    int startk, i, k, b, n, rcode, ext, last = -1;
+
+    if (NULL == en->seqoff)
+        if (SUCCESS != (rcode = enmCreateSeqoff(en)))
+            return rcode;
+
+    startk = MIN(en->pi->maxpowerXintI,NALG);
+    for (k=0;k<startk;k++) {
+        int prd = MIN(en->profile.r.dat[k], en->algebra.r.dat[k]);
+        maxd[k] = (en->algebra.r.dat[k] - prd) * en->pi->reddegs[k];
+        prof[k] = en->profile.r.dat[k];
+        rdeg[k] = en->pi->reddegs[k];
+    }
+
+    for (b=0;b<num;b+=n,ex+=n,seqno+=n) {
+        n = MIN(SEQBATCH, num-b);
+
+        /* find the effective generators */
+        for (i=0;i<n;i++) {
+            ext = en->ispos ? ex[i].ext : (-1 - ex[i].ext);
+            ext ^= (ext & en->profile.ext);
+            if ((last < 0) || (ex[i].gen != en->efflist[last].id)
+                || (ext != en->efflist[last].ext))
+                last = enmFindEffgen(en, ex[i].gen, ext);
+            off[i] = (last < 0) ? -1 : en->seqoff[last];
+            deg[i] = (last < 0) ? 0 : en->efflist[last].rrideg;
+            cnt[i] = 0;
+        }
+
+        /* now the algebra part, as in algSeqnoWithRDegree */
+        for (k=startk;k--;) {
+            const seqint *tab = en->seqtab[k];
+            int md = maxd[k], pr = prof[k], rd = rdeg[k], tl = en->tablen;
+            for (i=0;i<n;i++) {
+                int d = deg[i], mx = MIN(d, md), exo, act;
+                exo = en->ispos ? ex[i].r.dat[k] : (-1 - ex[i].r.dat[k]);
+                act = (exo / pr) * pr * rd;
+                if ((d < act) || ((d - act) >= tl) || ((d - mx) >= tl)) {
+                    off[i] = -1;
+                    continue;
+                }
+                cnt[i] += tab[d - act] - tab[d - mx];
+                deg[i] = d - act;
+            }
+        }
+
+        for (i=0;i<n;i++)
+            seqno[i] = ((off[i] < 0) || (cnt[i] < 0)) ? -1 : (off[i] + cnt[i]);
+    }
+
+    return SUCCESS;
+}
+
+/* Unranking: the inverse of SeqnoFromEnum. The efflist entry is found
+ * by bisection in seqoff; the reduced part is then built from the top
+ * variable down, skipping as many completions (counted by dimtab) as
+ * the enumeration would have produced before. */
+
+int ExmoFromSeqno(enumerator *en, seqint seqno, exmo *ex) {
+    int lo, hi, idx, deg, i, rcode;
 
     if (NULL == en->seqoff)
-        if (SUCCESS != enmCreateSeqoff(en))
-            return -666;
+        if (SUCCESS != (rcode = enmCreateSeqoff(en)))
+            return rcode;
+
+    if ((seqno < 0) || (seqno >= en->totaldim)) return FAILIMPOSSIBLE;
 
-    aux.id  = ex->gen;
-    aux.ext = en->ispos ? ex->ext : (-1 - ex->ext);
-    aux.ext ^= (aux.ext & en->profile.ext);
-    res = (effgen *) bsearch(&aux, en->efflist, en->efflen,
-                             sizeof(effgen), compareEffgen);
-    if (NULL == res) return -1;
+    /* last entry with seqoff <= seqno; this one has positive dimension */
+    for (lo=0, hi=en->efflen; hi-lo > 1;) {
+        int mid = (lo + hi) / 2;
+        if (en->seqoff[mid] <= seqno) lo = mid; else hi = mid;
+    }
+    idx = lo;
 
-    cnt = en->seqoff[res - en->efflist];
-    cnt2 = algSeqnoWithRDegree(en, ex, res->rrideg);
-    if (cnt2 < 0) return -1;
-    return cnt + cnt2;
+    seqno -= en->seqoff[idx];
+    deg = en->efflist[idx].rrideg;
+
+    for (i=NALG;i-- > 1;) {
+        int rd = en->pi->reddegs[i], pr = en->profile.r.dat[i];
+        int nval = deg / rd;
+        if (nval > en->algebra.r.dat[i]-1)
+            nval = en->algebra.r.dat[i]-1;
+        nval /= pr; nval *= pr;
+        for (; nval > 0; nval -= pr) {
+            seqint cnt = en->dimtab[i-1][deg - nval * rd];
+            if (seqno < cnt) break;
+            seqno -= cnt;
+        }
+        ex->r.dat[i] = nval;
+        deg -= nval * rd;
+    }
+    ex->r.dat[0] = deg;
+
+    if (seqno || (0 == en->dimtab[0][deg])) return FAILIMPOSSIBLE;
+
+    for (i=NALG;i--;) {
+        ex->r.dat[i] += en->signature.r.dat[i];
+        if (!en->ispos) ex->r.dat[i] = -1 - ex->r.dat[i];
+    }
+    ex->gen   = en->efflist[idx].id;
+    ex->ext   = en->efflist[idx].ext | en->signature.ext;
+    if (!en->ispos) ex->ext = -1 - ex->ext;
+    ex->coeff = 1;
+
+    return SUCCESS;
 }
 
-int DimensionFromEnum(enumerator *en) {
+int enmDimension(enumerator *en, seqint *res) {
+    int rcode;
     if (NULL == en->seqoff)
-        if (SUCCESS != enmCreateSeqoff(en))
-            return -666;
-    return en->totaldim;
+        if (SUCCESS != (rcode = enmCreateSeqoff(en)))
+            return rcode;
+    *res = en->totaldim;
+    return SUCCESS;
+}
+
+seqint DimensionFromEnum(enumerator *en) {
+    seqint res;
+    if (SUCCESS != enmDimension(en, &res)) return -1;
+    return res;
+}
+
+/* Dimensions for a whole range of tridegrees (ideg, edeg, en->hdeg) with
+ * ilo <= ideg <= ihi and elo <= edeg <= ehi. The result is stored in res,
+ * indexed by (ideg - ilo) * (ehi - elo + 1) + (edeg - elo). This runs
+ * through the same generator/exterior combinations as enmRecreateEfflist,
+ * but only looks up the algebra dimensions in dimtab. If profile is not
+ * NULL it replaces the enumerator's profile for this computation; it is
+ * given in the same form as for enmSetBasics. */
+
+static int enmDimensionTable(enumerator *en, int sideg, int sedeg,
+                             int ilo, int ihi, int elo, int ehi, seqint *res) {
+    int ni = ihi - ilo + 1, ne = ehi - elo + 1;
+    int tpmo, maxr, i, k, rcode, *glp;
+
+    memset(res, 0, (size_t) ni * ne * sizeof(seqint));
+
+    tpmo = en->pi->tpmo;
+
+    /* make sure that the tables cover all degrees that can occur */
+    for (maxr=0,i=0,glp=en->genList; i<en->numgens; i++,glp+=4) {
+        int rideg = en->ispos ? (ihi - sideg - glp[1]) : (glp[1] - ilo - sideg);
+        if ((glp[3] == en->hdeg) && (rideg / tpmo > maxr))
+            maxr = rideg / tpmo;
+    }
+
+    if ((NULL == en->seqtab[0]) || (maxr > en->tabmaxrideg)) {
+        int save = en->maxrrideg;
+        en->maxrrideg = MAX(save, maxr);
+        rcode = enmCreateSeqtab(en);
+        en->maxrrideg = save;
+        if (SUCCESS != rcode) return rcode;
+    }
+
+    for (i=0,glp=en->genList; i<en->numgens; i++,glp+=4) {
+        int gideg = glp[1], gedeg = glp[2];
+        if (glp[3] != en->hdeg) continue;
+        for (k=0; k<ni; k++) {
+            int rideg = en->ispos ? (ilo + k - sideg - gideg)
+                                  : (gideg - ilo - k - sideg);
+            seqint *row = res + (size_t) k * ne;
+            int ext;
+            if (rideg < 0) continue;
+            ext = getMaxExterior(en->pi, &(en->algebra), &(en->profile), rideg);
+            for (;ext>=0;ext--) {
+                int extideg, edeg;
+                seqint dim;
+                if (0 != (ext & en->profile.ext)) continue;
+                if ((extideg = extdeg(en->pi, ext)) > rideg) continue;
+                if (0 != ((rideg - extideg) % tpmo)) continue;
+                edeg = en->ispos ? (gedeg + BITCOUNT(ext) + sedeg)
+                                 : (gedeg - BITCOUNT(ext) - sedeg);
+                if ((edeg < elo) || (edeg > ehi)) continue;
+                dim = algDimension(en, (rideg - extideg) / tpmo);
+                if (dim > SEQINTMAX - row[edeg - elo]) return FAILOVERFLOW;
+                row[edeg - elo] += dim;
+            }
+        }
+    }
+
+    return SUCCESS;
+}
+
+int DimensionTableFromEnum(enumerator *en, exmo *profile,
+                           int ilo, int ihi, int elo, int ehi, seqint *res) {
+    int sideg, sedeg, rcode, i;
+    exmo sig;
+
+    if (NULL == en->pi) return FAILIMPOSSIBLE;
+    if ((ilo > ihi) || (elo > ehi)) return SUCCESS;
+
+    if (NULL != profile) {
+        enumerator *cp;
+        if (NULL == (cp = enmCopy(en))) return FAILMEM;
+        copyExpExmo(cp->pi, &(cp->profile), profile);
+        cp->profile.ext &= cp->algebra.ext;
+        for (i=NALG; i--;)
+            cp->profile.r.dat[i] = MIN(cp->profile.r.dat[i], cp->algebra.r.dat[i]);
+        enmDestroyEffList(cp);
+        enmDestroySeqtab(cp);
+        enmDestroySigtab(cp);
+        rcode = DimensionTableFromEnum(cp, NULL, ilo, ihi, elo, ehi, res);
+        enmDestroy(cp);
+        freex(cp);
+        return rcode;
+    }
+
+    copyExmo(&sig, &(en->signature));
+    enmUpdateSigInfo(en, &sig, &sideg, &sedeg);
+
+    return enmDimensionTable(en, sideg, sedeg, ilo, ihi, elo, ehi, res);
+}
+
+/* The signature table lists all signatures in the order of nextSignature,
+ * together with the dimension of each signature's part of the basis and
+ * the offset of that part in the signature-major ordering of the full
+ * basis (i.e. the sum of the dimensions of all preceding signatures).
+ * The dimensions come from a single enmDimensionTable computation. */
+
+int enmCreateSigtab(enumerator *en) {
+    exmo sig;
+    int sideg, sedeg, num, nalloc, maxi, maxe, ilo, ihi, elo, ehi, ne;
+    int i, rcode;
+    seqint cnt, *tab;
+    sigentry *st = NULL;
+
+    if (NULL == en->pi) return FAILIMPOSSIBLE;
+    enmDestroySigtab(en);
+
+    /* collect the signatures */
+    memset(&sig, 0, sizeof(exmo));
+    sideg = sedeg = 0;
+    num = nalloc = maxi = maxe = 0;
+    do {
+        if (num == nalloc) {
+            sigentry *aux;
+            nalloc = 2 * nalloc + 16;
+            if (NULL == (aux = (sigentry *) reallox(st, nalloc * sizeof(sigentry)))) {
+                if (NULL != st) freex(st);
+                return FAILMEM;
+            }
+            st = aux;
+        }
+        copyExmo(&(st[num].sig), &sig);
+        enmUpdateSigInfo(en, &(st[num].sig), &(st[num].sideg), &(st[num].sedeg));
+        maxi = MAX(maxi, st[num].sideg);
+        maxe = MAX(maxe, st[num].sedeg);
+        num++;
+    } while (nextSignature(en, &sig, &sideg, &sedeg));
+
+    /* dimensions of the signature-zero enumerator in all shifted degrees */
+    if (en->ispos) {
+        ilo = en->ideg - maxi; ihi = en->ideg;
+        elo = en->edeg - maxe; ehi = en->edeg;
+    } else {
+        ilo = en->ideg; ihi = en->ideg + maxi;
+        elo = en->edeg; ehi = en->edeg + maxe;
+    }
+    ne = ehi - elo + 1;
+
+    if (NULL == (tab = (seqint *) mallox((size_t) (ihi - ilo + 1) * ne * sizeof(seqint)))) {
+        freex(st);
+        return FAILMEM;
+    }
+
+    if (SUCCESS != (rcode = enmDimensionTable(en, 0, 0, ilo, ihi, elo, ehi, tab))) {
+        freex(tab);
+        freex(st);
+        return rcode;
+    }
+
+    for (cnt=i=0; i<num; i++) {
+        int ideg = en->ispos ? (en->ideg - st[i].sideg) : (en->ideg + st[i].sideg);
+        int edeg = en->ispos ? (en->edeg - st[i].sedeg) : (en->edeg + st[i].sedeg);
+        st[i].dim = tab[(ideg - ilo) * ne + (edeg - elo)];
+        st[i].offset = cnt;
+        if (st[i].dim > SEQINTMAX - cnt) {
+            freex(tab);
+            freex(st);
+            return FAILOVERFLOW;
+        }
+        cnt += st[i].dim;
+    }
+
+    freex(tab);
+
+    en->sigtab = st;
+    en->siglen = num;
+    en->sigdim = cnt;
+
+    return SUCCESS;
 }
 
 /**** ENUMERATION ************************************************************/
@@ -607,7 +1273,7 @@ int nextRedmonAux(enumerator *en, int *algdim) {
             en->theex.ext = en->efflist[en->gencnt].ext | en->signature.ext;
             if (!en->ispos)
                 en->theex.ext = -1 - en->theex.ext;
-            if(algdim) *algdim = algDimension(en,rdeg);
+            if(algdim) *algdim = (int) MIN(algDimension(en,rdeg), INT_MAX);
             return 1;
         }
         ++(en->gencnt);
@@ -637,6 +1303,43 @@ int nextRedmonWithAlgDim(enumerator *en, int *algdim) {
     return nextRedmonAux(en,algdim);
 }
 
+/* Run through the basis in chunks of at most "chunk" elements; func is
+ * called with each chunk and stops the enumeration by returning anything
+ * other than SUCCESS. That value is then returned. The enumeration uses
+ * a private copy of en, so func may reconfigure the enumerator. */
+
+int enmForeachBasis(enumerator *en, int chunk, basisChunkFunc *func, void *cd) {
+    enumerator *cp;
+    exmo *buf;
+    int num = 0, rcode = SUCCESS;
+    seqint seqno = 0;
+
+    if (chunk < 1) return FAILIMPOSSIBLE;
+    if (NULL == (cp = enmCopy(en))) return FAILMEM;
+    if (NULL == (buf = (exmo *) mallox(chunk * sizeof(exmo)))) {
+        enmDestroy(cp); freex(cp);
+        return FAILMEM;
+    }
+
+    if (firstRedmon(cp))
+        do {
+            copyExmo(&(buf[num++]), &(cp->theex));
+            if (num == chunk) {
+                if (SUCCESS != (rcode = (func)(cd, buf, num, seqno))) break;
+                seqno += num; num = 0;
+            }
+        } while (nextRedmon(cp));
+
+    if ((SUCCESS == rcode) && num)
+        rcode = (func)(cd, buf, num, seqno);
+
+    freex(buf);
+    enmDestroy(cp);
+    freex(cp);
+
+    return rcode;
+}
+
 /**** SIGNATURE ENUMERATION **************************************************/
 
 int nextSignature(enumerator *en, exmo *sig, int *sideg, int *sedeg) {
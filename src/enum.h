@@ -15,6 +15,14 @@
 #define ENUM_DEF
 
 #include "poly.h"
+#include <limits.h>
+
+/* data type for sequence numbers and dimensions */
+typedef long long seqint;
+#define SEQINTMAX LLONG_MAX
+
+/* whether a sequence number or dimension can be used as a matrix index */
+#define SEQINTFITS(x) (((x) >= 0) && ((x) <= INT_MAX))
 
 /* effgen = effective generator; used internally in the enumerator structure */
 typedef struct {
@@ -23,6 +31,27 @@ typedef struct {
     int rrideg; /* reduced, remaining internal degree */
 } effgen;
 
+/* dimtab/seqtab tables, shared between enumerators with the same prime,
+ * algebra and profile; see enmCreateSeqtab */
+typedef struct seqtabs {
+    int             refcnt;
+    int             prime;
+    exmo            algebra, profile;
+    int             effdeg[NALG];
+    int             tablen, tabmaxrideg;
+    seqint         *dimtab[NALG+1];
+    seqint         *seqtab[NALG+1];
+    struct seqtabs *next;
+} seqtabs;
+
+/* entry of the signature table; see enmCreateSigtab */
+typedef struct {
+    exmo sig;           /* the signature */
+    int  sideg, sedeg;  /* its internal and exterior degree */
+    seqint dim;         /* dimension of the basis with this signature */
+    seqint offset;      /* sum of the dimensions of all previous signatures */
+} sigentry;
+
 typedef struct {
     /* description of the algebra/subalgebra pair */
     exmo       algebra, profile, signature;
@@ -48,20 +77,32 @@ typedef struct {
     int extdeg;
     int sigideg, sigedeg; 
 
-    /* tables that are used for sequence number computations */
+    /* tables that are used for sequence number computations; these
+     * point into the shared *tabs and must not be modified */
+    seqtabs *tabs;
     int effdeg[NALG];      /* this is "reddeg * profile" */
     int tablen;            /* length of the following arrays */
     int tabmaxrideg;       /* maximal reduced internal degree */
-    int *dimtab[NALG+1]; 
-    int *seqtab[NALG+1]; 
-    int totaldim;
+    seqint *dimtab[NALG+1];
+    seqint *seqtab[NALG+1];
+    seqint totaldim;
 
     /* list of effective generators, and their sequence number offsets */
     effgen    *efflist;
-    int       *seqoff;
+    seqint    *seqoff;
     int        efflen, effalloc;
     int        maxrrideg, maxredeg;  
 
+    /* hash index (gen, ext) -> position in efflist; built with seqoff */
+    int       *effidx;
+    int        effmsk;
+    unsigned   effmul;
+
+    /* table of all signatures, built on demand by enmCreateSigtab */
+    sigentry  *sigtab;
+    int        siglen;
+    seqint     sigdim;
+
 } enumerator;
 
 enumerator *enmCreate(void);
@@ -85,6 +126,10 @@ int enmSetSignature(enumerator *en, exmo *sig);
 int enmSetTridegree(enumerator *en, int ideg, int edeg, int hdeg);
 int enmSetGenlist(enumerator *en, int *gl, int num);
 
+/* append generators with nondecreasing internal degrees to the genlist;
+ * the efflist and the sequence number offsets are updated incrementally */
+int enmAddGens(enumerator *en, const int *gl, int num);
+
 /* enumeration uses these procedures. the enumerated exmo is "theex". */
 int firstRedmon(enumerator *en);
 int nextRedmon(enumerator *en);
@@ -92,13 +137,41 @@ int nextRedmon(enumerator *en);
 int firstRedmonWithAlgDim(enumerator *en, int *algdim);
 int nextRedmonWithAlgDim(enumerator *en, int *algdim);
 
-int SeqnoFromEnum(enumerator *en, exmo *ex);
-int DimensionFromEnum(enumerator *en);
+/* callback interface: func gets the basis elements with sequence numbers
+ * seqno, ..., seqno+num-1; anything but SUCCESS stops the enumeration */
+typedef int (basisChunkFunc)(void *cd, const exmo *ex, int num, seqint seqno);
+int enmForeachBasis(enumerator *en, int chunk, basisChunkFunc *func, void *cd);
+
+/* sequence number of *ex in *res; FAILUNTRUE if *ex is not in the basis */
+int enmSeqno(enumerator *en, const exmo *ex, seqint *res);
+/* dimension of the basis in *res */
+int enmDimension(enumerator *en, seqint *res);
+
+/* same as above, but -1 is returned for errors or monomials that are
+ * not in the basis */
+seqint SeqnoFromEnum(enumerator *en, exmo *ex);
+seqint DimensionFromEnum(enumerator *en);
+
+/* compute the sequence numbers of ex[0], ..., ex[num-1] in one pass;
+ * seqno[i] is set to -1 if ex[i] cannot be found in the basis */
+int SeqnoFromEnumBatch(enumerator *en, const exmo *ex, int num, seqint *seqno);
+/* construct the basis element with the given sequence number in *ex */
+int ExmoFromSeqno(enumerator *en, seqint seqno, exmo *ex);
+
+/* dimensions for the range ilo <= ideg <= ihi, elo <= edeg <= ehi;
+ * res has (ihi-ilo+1)*(ehi-elo+1) entries, rows indexed by ideg */
+int DimensionTableFromEnum(enumerator *en, exmo *profile,
+                           int ilo, int ihi, int elo, int ehi, seqint *res);
 
 /* signature enumeration; the first signature is always zero */
 int nextSignature(enumerator *en, exmo *sig, int *sideg, int *sedeg);
 int enmIncrementSig(enumerator *en);
 
+/* precompute all signatures with their dimensions and offsets;
+ * the table is kept in en->sigtab until the configuration changes */
+int enmCreateSigtab(enumerator *en);
+void enmDestroySigtab(enumerator *en);
+
 /* An enumpoly allows to access an enumerator as a polynomial */
 
 #ifndef ENUMC
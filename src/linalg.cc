@@ -15,6 +15,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 #ifdef USESSE2
 #  include "ssedefs.h"
@@ -50,7 +51,7 @@ int COMPAREBLOCKSDBG(__m128i x,__m128i y) {
 #endif
 
 static inline
-int BLOCKSAREZERO(BLOCKTYPE *dat, int numblocks) {
+int BLOCKSAREZERO(BLOCKTYPE *dat, size_t numblocks) {
 #ifdef USESSE2
     const __m128i zero = _mm_setzero_si128();
 #else
@@ -68,7 +69,7 @@ int vector_iszero(vector *v) {
 
 
 int matrix_iszero(matrix *m) {
-    return BLOCKSAREZERO(m->data,m->nomcols * m->rows);
+    return BLOCKSAREZERO(m->data,(size_t) m->nomcols * m->rows);
 }
 
 void vector_copy(vector *v, vector *w) {
@@ -161,8 +162,11 @@ matrix *matrix_create(int rows, int cols) {
     /* make this a multiple of 8, might help to speed things up */
     res->nomcols = (7 + res->nomcols)/8; res->nomcols *= 8;
 #endif
+    if (rows < 0) {
+        freex(res); return NULL;
+    }
     res->data = (BLOCKTYPE *)
-        mallox(sizeof(BLOCKTYPE) * res->nomcols * res->rows);
+        mallox(sizeof(BLOCKTYPE) * (size_t) res->nomcols * res->rows);
     if (NULL == res->data) {
         freex(res); return NULL;
     }
@@ -176,20 +180,48 @@ void matrix_destroy(matrix *mat) {
 matrix *matrix_copy(matrix *mat) {
     matrix *res = matrix_create(mat->rows, mat->cols);
     if (NULL == res) return NULL;
-    if(mat->data) memcpy(res->data, mat->data, sizeof(BLOCKTYPE) * mat->nomcols * mat->rows);
+    if(mat->data) memcpy(res->data, mat->data, sizeof(BLOCKTYPE) * (size_t) mat->nomcols * mat->rows);
     return res;
 }
 
 int matrix_copy_rows(matrix *d, int start, matrix *s, int f, int nrows) {
-  void *dbase = d->data + d->nomcols * start;
-  void *sbase = s->data + s->nomcols * f;
-  size_t nbytes = d->nomcols * nrows;
-  memcpy(dbase,sbase,sizeof(BLOCKTYPE)*d->nomcols*nrows);
+  memcpy(MATROW(d,start),MATROW(s,f),sizeof(BLOCKTYPE)*(size_t)d->nomcols*nrows);
   return 1;
 }
 
+/* tiles of TRANSPOSETILE x TRANSPOSETILE entries are transposed in one go */
+#define TRANSPOSETILE 64
+
+matrix *matrix_transpose(matrix *m) {
+    matrix *res = matrix_create(m->cols, m->rows);
+    int i0, j0, i, j;
+    if (NULL == res) return NULL;
+    matrix_clear(res);
+    for (i0=0; i0<m->rows; i0+=TRANSPOSETILE)
+        for (j0=0; j0<m->cols; j0+=TRANSPOSETILE)
+            for (i=i0; (i<i0+TRANSPOSETILE) && (i<m->rows); i++) {
+                const cint *src = MATROW(m, i);
+                for (j=j0; (j<j0+TRANSPOSETILE) && (j<m->cols); j++)
+                    MATROW(res, j)[i] = src[j];
+            }
+    return res;
+}
+
+matrix *matrix_extract_cols(matrix *m, const int *idx, int num) {
+    matrix *res = matrix_create(m->rows, num);
+    int i, j;
+    if (NULL == res) return NULL;
+    matrix_clear(res);
+    for (i=0; i<m->rows; i++) {
+        const cint *src = MATROW(m, i);
+        cint *dst = MATROW(res, i);
+        for (j=0; j<num; j++) dst[j] = src[idx[j]];
+    }
+    return res;
+}
+
 void matrix_clear(matrix *mat) {
-    memset(mat->data, 0, sizeof(BLOCKTYPE) * mat->nomcols * mat->rows);
+    memset(mat->data, 0, sizeof(BLOCKTYPE) * (size_t) mat->nomcols * mat->rows);
 }
 
 void matrix_unit(matrix *mat) {
@@ -209,7 +241,7 @@ void matrix_unit(matrix *mat) {
 void make_matrix_row(vector *v, matrix *m, int r) {
     v->num = m->cols;
     v->blocks = m->nomcols;
-    v->data = m->data + (m->nomcols * r);
+    v->data = m->data + (size_t) m->nomcols * r;
 }
 
 vector *matrix_get_row(matrix *m, int r) {
@@ -221,18 +253,18 @@ vector *matrix_get_row(matrix *m, int r) {
 
 cint matrix_get_entry(matrix *m, int r, int c) {
 #ifdef USESSE2
-    return extract_entry(m->data[m->nomcols * r + c/16],c & 15);
+    return extract_entry(m->data[(size_t) m->nomcols * r + c/16],c & 15);
 #else
-    cint *rowptr = m->data + (m->nomcols * r);
+    cint *rowptr = MATROW(m, r);
     return rowptr[c];
 #endif
 }
 
 void matrix_set_entry(matrix *m, int r, int c, cint val) {
 #ifdef USESSE2
-    set_entry(&(m->data[m->nomcols * r + c/16]),c & 15,val);
+    set_entry(&(m->data[(size_t) m->nomcols * r + c/16]),c & 15,val);
 #else
-    cint *rowptr = m->data + (m->nomcols * r);
+    cint *rowptr = MATROW(m, r);
     rowptr[c] = val;
 #endif
 }
@@ -240,7 +272,7 @@ void matrix_set_entry(matrix *m, int r, int c, cint val) {
 void matrix_add(matrix *dst, matrix *src, cint coeff, cint prime) {
 #ifdef USESSE2
     if ((dst->rows != src->rows) || (dst->cols != src->cols)) return;
-    add_blocks(dst->data,src->data,dst->nomcols * dst->rows,coeff,prime);
+    add_blocks(dst->data,src->data,(size_t) dst->nomcols * dst->rows,coeff,prime);
 #else
     int i;
     vector v1, v2;
@@ -274,7 +306,7 @@ void matrix_collect(matrix *m, int r) {
 
 /* try to shrink or enlarge m; move if necessary */
 int matrix_resize(matrix *m, int newrows) {
-    int nsz = m->nomcols * sizeof(BLOCKTYPE) * newrows;
+    size_t nsz = (size_t) m->nomcols * sizeof(BLOCKTYPE) * newrows;
     BLOCKTYPE *nw;
     nw = (BLOCKTYPE *) reallox(m->data, nsz);
     if ((NULL!=nw) || (0 == nsz)) {
@@ -295,11 +327,11 @@ void matrix_randomize(matrix *m, cint prime) {
 
 void matrix_reduce(matrix *m, cint prime) {
 #ifdef USESSE2
-    reduce_blocks(m->data,m->nomcols * m->rows,prime);
+    reduce_blocks(m->data,(size_t) m->nomcols * m->rows,prime);
 #else
     cint *rowptr; int i,j;
     for (j=m->rows;j--;) {
-        rowptr = m->data + j* m->nomcols;
+        rowptr = MATROW(m, j);
         for (i=m->cols;i--;)
             rowptr[i] %= prime;
     }
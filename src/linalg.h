@@ -40,6 +40,9 @@ typedef struct {
     BLOCKTYPE *data;
 } matrix;
 
+/* the entries of row r of m, one cint each */
+#define MATROW(m,r) ((cint *) ((m)->data + (size_t) (r) * (m)->nomcols))
+
 vector * vector_create(int size);
 void vector_dispose(vector *v);
 void vector_clear(vector *v);
@@ -77,4 +80,9 @@ void matrix_collect_ext(matrix *dest, matrix *src, int r);
 /* copy some rows from s to d */
 int matrix_copy_rows(matrix *d, int start, matrix *s, int f, int nrows);
 
+/* new matrices holding the transpose of m, resp. the columns
+ * idx[0],...,idx[num-1] of m */
+matrix *matrix_transpose(matrix *m);
+matrix *matrix_extract_cols(matrix *m, const int *idx, int num);
+
 #endif
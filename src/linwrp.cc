@@ -128,6 +128,18 @@ void stdQuotFunc(primeInfo *pi, void *ker, void *im, progressInfo *prg) {
     matrix_quotient(pi, (matrix *) ker, (matrix *) im, ip, progvar, pmsk, ivarp ? ivarp : &zero);
 }
 
+int stdMultFunc(void *res, void *m1, void *m2, int prime) {
+    return matrix_multiply((matrix *) res, (matrix *) m1, (matrix *) m2, prime);
+}
+
+void *stdTransposeMatrix(void *mat) {
+    return matrix_transpose((matrix *) mat);
+}
+
+void *stdExtractCols(void *mat, int *idx, int num) {
+    return matrix_extract_cols((matrix *) mat, idx, num);
+}
+
 int stdMAdd(void *vv1, void *vv2, int scale, int mod) {
     matrix *v1 = (matrix *) vv1;
     matrix *v2 = (matrix *) vv2;
@@ -158,7 +170,10 @@ matrixType stdMatrixType = {
     .orthoFunc     = stdOrthoFunc,
     .liftFunc      = stdLiftFunc,
     .quotFunc      = stdQuotFunc,
-    .copyRows      = stdMatrixCopyRows
+    .copyRows      = stdMatrixCopyRows,
+    .multFunc      = stdMultFunc,
+    .transpose     = stdTransposeMatrix,
+    .extractCols   = stdExtractCols
 };
 
 int stdVGetEntry(void *vec, int idx, int *val) {
@@ -299,26 +314,30 @@ vectorType matrixRowcolVector = {
     .reduce        = NULL
 };
 
-void *createStdMatrixCopy(matrixType *mt, void *mat) {
+void *createMatrixCopy(matrixType *dt, matrixType *mt, void *mat) {
     int rows, cols, i, j, val;
     void *res;
     (mt->getDimensions)(mat, &rows, &cols);
-    res = (stdmatrix->createMatrix)(rows, cols);
+    res = (dt->createMatrix)(rows, cols);
     if (NULL == res) return NULL;
     for (i=0;i<rows;i++)
         for (j=0;j<cols;j++) {
             if (SUCCESS != (mt->getEntry)(mat,i,j,&val)) {
-                (stdmatrix->destroyMatrix)(res);
+                (dt->destroyMatrix)(res);
                 return NULL;
             }
-            if (SUCCESS != (stdmatrix->setEntry)(res,i,j,val)) {
-                (stdmatrix->destroyMatrix)(res);
+            if (SUCCESS != (dt->setEntry)(res,i,j,val)) {
+                (dt->destroyMatrix)(res);
                 return NULL;
             }
         }
     return res;
 }
 
+void *createStdMatrixCopy(matrixType *mt, void *mat) {
+    return createMatrixCopy(stdmatrix, mt, mat);
+}
+
 void *createStdVectorCopy(vectorType *vt, void *vec) {
     int len, i, val;
     void *res;
@@ -61,6 +61,13 @@ typedef struct {
   void *(*liftFunc)(primeInfo *pi, void *inp, void *lft, void *bas, progressInfo *prg);
     void (*quotFunc)(primeInfo *pi, void *ker, void *im, progressInfo *prg);
   int (*copyRows)(void *dst, int startrow, void *src, int from, int nrows);
+  /* multFunc computes res = m1 * m2 mod prime, where res is a matrix of this
+   * type with the right dimensions. It returns FAILIMPOSSIBLE for primes it
+   * does not support. */
+  int (*multFunc)(void *res, void *m1, void *m2, int prime);
+  /* new matrices holding the transpose, resp. the given (valid) columns */
+  void *(*transpose)(void *mat);
+  void *(*extractCols)(void *mat, int *idx, int num);
 } matrixType;
 
 #ifndef LINWRPC
@@ -72,17 +79,23 @@ extern vectorType stdVectorType;
 extern matrixType stdMatrixType2;
 extern vectorType stdVectorType2;
 #endif
+// sparse matrices with structured elimination, see sparse.cc
+extern matrixType sparseMatrixType;
 
 #define stdmatrix (&(stdMatrixType))
 #define stdvector (&(stdVectorType))
 #define stdmatrix2 (&(stdMatrixType2))
 #define stdvector2 (&(stdVectorType2))
+#define sparsematrix (&(sparseMatrixType))
 
 extern vectorType matrixRowcolVector;
 
 void *CreateMatrixRowcolVector(Tcl_Obj *matrix, int rcnum, int roworcol);
 
 void *createStdMatrixCopy(matrixType *mt, void *mat);
+
+/* a copy of mat with the dense type dt, by entries */
+void *createMatrixCopy(matrixType *dt, matrixType *mt, void *mat);
 void *createStdVectorCopy(vectorType *vt, void *vec);
 
 int LAVadd(vectorType **vt1, void **vec1,
@@ -96,24 +109,45 @@ int matrixIsZero(matrixType *mt, void *mdat);
 
 /* selected internals for the 2-primary implementation */
 
-#define BITSPERINT (sizeof(int) * 8)
-#if USEOPENCL
-#  define MAT2ALIGN (16*BITSPERINT)
-#else 
-#  define MAT2ALIGN BITSPERINT
-#endif
+/* the rows of a mat2 are arrays of 64 bit words, column c being bit
+ * c % 64 of word c / 64. On little endian machines this is the memory
+ * layout of the earlier int based rows, which the OpenCL code relies on. */
+typedef unsigned long long m2word;
+
+#define BITSPERWORD (sizeof(m2word) * 8)
+
+/* matrices with at least this many rows are eliminated recursively,
+ * see linwrp2.cc; linked to steenrod::_pleminrows */
+extern int thepleminrows;
+
+/* rows are padded to a multiple of 64 bytes */
+#define MAT2ALIGN 512
 
-#define IPROCO(cols) (((MAT2ALIGN-1+(cols))/MAT2ALIGN)*(MAT2ALIGN/BITSPERINT))
+#define IPROCO(cols) (((MAT2ALIGN-1+(cols))/MAT2ALIGN)*(MAT2ALIGN/BITSPERWORD))
 
 typedef struct {
-    int *data;
+    m2word *data;
     int size, ints;
 } vec2;
 
 typedef struct {
-    int *data;
+    m2word *data;
     int rows, cols;
-    int ipr; /* ints per row */
+    int ipr; /* words per row */
 } mat2;
 
+/* a pseudo random stdmatrix2: bit j of the 32 bit word c of a row is
+ * the entry in column 32*c+j, as with the OpenCL random generator */
+void *stdRandomMatrix2(int row, int col, int rounds, unsigned int seed);
+
+/* dst ^= src for n words, using the widest vector unit available */
+void vector_add2(m2word *dst, const m2word *src, int n);
+
+/* dst ^= s0 ^ s1 ^ s2 ^ s3 over n words */
+void vector_add2x4(m2word *dst, const m2word *s0, const m2word *s1,
+                   const m2word *s2, const m2word *s3, int n);
+
+/* index of the lowest set bit among n words, or -1 */
+int vector_firstbit2(const m2word *v, int n);
+
 #endif
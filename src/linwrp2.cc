@@ -12,11 +12,230 @@
 #define LINWRPC2
 
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 #include "linwrp.h"
+#include "parallel.h"
+#include "dense2.h"
+
+/* M2SIMD selects the row kernels that are compiled in:
+ *   0 = plain C only, 1 = up to AVX2, 2 = up to AVX-512.
+ * The choice among those is made at run time from the CPU features. */
+#ifndef M2SIMD
+#  if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#    define M2SIMD 2
+#  else
+#    define M2SIMD 0
+#  endif
+#endif
+
+#if M2SIMD
+#  include <immintrin.h>
+#endif
+
+/**** ROW KERNELS ***********************************************************/
+
+static void vector_add2_plain(m2word *a, const m2word *b, int n) {
+    while (n--) *a++ ^= *b++;
+}
+
+static void vector_add2x4_plain(m2word *a, const m2word *b0, const m2word *b1,
+                                const m2word *b2, const m2word *b3, int n) {
+    while (n--) *a++ ^= *b0++ ^ *b1++ ^ *b2++ ^ *b3++;
+}
+
+static int vector_firstbit2_plain(const m2word *v, int n) {
+    int j;
+    for (j=0; j<n; j++)
+        if (0 != v[j]) return j * BITSPERWORD + __builtin_ctzll(v[j]);
+    return -1;
+}
+
+#if M2SIMD
+
+__attribute__((target("avx2")))
+static void vector_add2_avx2(m2word *a, const m2word *b, int n) {
+    for (; n >= 4; n -= 4, a += 4, b += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) a);
+        __m256i y = _mm256_loadu_si256((const __m256i *) b);
+        _mm256_storeu_si256((__m256i *) a, _mm256_xor_si256(x, y));
+    }
+    while (n--) *a++ ^= *b++;
+}
+
+__attribute__((target("avx2")))
+static void vector_add2x4_avx2(m2word *a, const m2word *b0, const m2word *b1,
+                               const m2word *b2, const m2word *b3, int n) {
+    for (; n >= 4; n -= 4, a += 4, b0 += 4, b1 += 4, b2 += 4, b3 += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) a);
+        __m256i y = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) b0),
+                                     _mm256_loadu_si256((const __m256i *) b1));
+        __m256i z = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) b2),
+                                     _mm256_loadu_si256((const __m256i *) b3));
+        _mm256_storeu_si256((__m256i *) a, _mm256_xor_si256(x, _mm256_xor_si256(y, z)));
+    }
+    while (n--) *a++ ^= *b0++ ^ *b1++ ^ *b2++ ^ *b3++;
+}
+
+__attribute__((target("avx2")))
+static int vector_firstbit2_avx2(const m2word *v, int n) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (v + j));
+        if (!_mm256_testz_si256(x, x)) break;
+    }
+    for (; j < n; j++)
+        if (0 != v[j]) return j * BITSPERWORD + __builtin_ctzll(v[j]);
+    return -1;
+}
+
+#if M2SIMD > 1
+
+/* the tails are handled with masked loads and stores, which do not
+ * touch the memory outside the mask */
+
+__attribute__((target("avx512f")))
+static void vector_add2_avx512(m2word *a, const m2word *b, int n) {
+    for (; n >= 8; n -= 8, a += 8, b += 8) {
+        __m512i x = _mm512_loadu_si512((const void *) a);
+        __m512i y = _mm512_loadu_si512((const void *) b);
+        _mm512_storeu_si512((void *) a, _mm512_xor_si512(x, y));
+    }
+    if (n) {
+        __mmask8 m = (__mmask8) ((1u << n) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(m, (const void *) a);
+        __m512i y = _mm512_maskz_loadu_epi64(m, (const void *) b);
+        _mm512_mask_storeu_epi64((void *) a, m, _mm512_xor_si512(x, y));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void vector_add2x4_avx512(m2word *a, const m2word *b0, const m2word *b1,
+                                 const m2word *b2, const m2word *b3, int n) {
+    for (; n >= 8; n -= 8, a += 8, b0 += 8, b1 += 8, b2 += 8, b3 += 8) {
+        __m512i x = _mm512_loadu_si512((const void *) a);
+        __m512i y = _mm512_xor_si512(_mm512_loadu_si512((const void *) b0),
+                                     _mm512_loadu_si512((const void *) b1));
+        __m512i z = _mm512_xor_si512(_mm512_loadu_si512((const void *) b2),
+                                     _mm512_loadu_si512((const void *) b3));
+        _mm512_storeu_si512((void *) a, _mm512_ternarylogic_epi64(x, y, z, 0x96));
+    }
+    if (n) {
+        __mmask8 m = (__mmask8) ((1u << n) - 1);
+        __m512i x = _mm512_maskz_loadu_epi64(m, (const void *) a);
+        __m512i y = _mm512_xor_si512(_mm512_maskz_loadu_epi64(m, (const void *) b0),
+                                     _mm512_maskz_loadu_epi64(m, (const void *) b1));
+        __m512i z = _mm512_xor_si512(_mm512_maskz_loadu_epi64(m, (const void *) b2),
+                                     _mm512_maskz_loadu_epi64(m, (const void *) b3));
+        _mm512_mask_storeu_epi64((void *) a, m, _mm512_ternarylogic_epi64(x, y, z, 0x96));
+    }
+}
+
+__attribute__((target("avx512f")))
+static int vector_firstbit2_avx512(const m2word *v, int n) {
+    int j;
+    __mmask8 nz;
+    for (j=0; j + 8 <= n; j += 8) {
+        __m512i x = _mm512_loadu_si512((const void *) (v + j));
+        if (0 != (nz = _mm512_test_epi64_mask(x, x))) break;
+    }
+    if (j + 8 > n) {
+        __mmask8 m;
+        __m512i x;
+        if (j == n) return -1;
+        m = (__mmask8) ((1u << (n - j)) - 1);
+        x = _mm512_maskz_loadu_epi64(m, (const void *) (v + j));
+        if (0 == (nz = _mm512_mask_test_epi64_mask(m, x, x))) return -1;
+    }
+    j += __builtin_ctz(nz);
+    return j * BITSPERWORD + __builtin_ctzll(v[j]);
+}
+
+#endif
+#endif
+
+static void vector_add2_select(m2word *a, const m2word *b, int n);
+static void vector_add2x4_select(m2word *a, const m2word *b0, const m2word *b1,
+                                 const m2word *b2, const m2word *b3, int n);
+static int vector_firstbit2_select(const m2word *v, int n);
+
+typedef void (vector_add2x4_func)(m2word *, const m2word *, const m2word *,
+                                  const m2word *, const m2word *, int);
+
+static void (*vector_add2_impl)(m2word *, const m2word *, int) = vector_add2_select;
+static vector_add2x4_func *vector_add2x4_impl = vector_add2x4_select;
+static int (*vector_firstbit2_impl)(const m2word *, int) = vector_firstbit2_select;
+
+/* pick the kernels on first use; concurrent callers all store the same values */
+static void vector_kernels2_select(void) {
+    void (*add)(m2word *, const m2word *, int) = vector_add2_plain;
+    vector_add2x4_func *add4 = vector_add2x4_plain;
+    int (*first)(const m2word *, int) = vector_firstbit2_plain;
+#if M2SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        add = vector_add2_avx2; first = vector_firstbit2_avx2;
+        add4 = vector_add2x4_avx2;
+    }
+#if M2SIMD > 1
+    if (__builtin_cpu_supports("avx512f")) {
+        add = vector_add2_avx512; first = vector_firstbit2_avx512;
+        add4 = vector_add2x4_avx512;
+    }
+#endif
+#endif
+    vector_firstbit2_impl = first;
+    vector_add2x4_impl = add4;
+    vector_add2_impl = add;
+}
+
+static void vector_add2_select(m2word *a, const m2word *b, int n) {
+    vector_kernels2_select();
+    vector_add2_impl(a, b, n);
+}
+
+static void vector_add2x4_select(m2word *a, const m2word *b0, const m2word *b1,
+                                 const m2word *b2, const m2word *b3, int n) {
+    vector_kernels2_select();
+    vector_add2x4_impl(a, b0, b1, b2, b3, n);
+}
+
+static int vector_firstbit2_select(const m2word *v, int n) {
+    vector_kernels2_select();
+    return vector_firstbit2_impl(v, n);
+}
+
+void vector_add2(m2word *a, const m2word *b, int n) {
+    vector_add2_impl(a, b, n);
+}
+
+void vector_add2x4(m2word *a, const m2word *b0, const m2word *b1,
+                   const m2word *b2, const m2word *b3, int n) {
+    vector_add2x4_impl(a, b0, b1, b2, b3, n);
+}
+
+int vector_firstbit2(const m2word *v, int n) {
+    return vector_firstbit2_impl(v, n);
+}
+
+/* matrix data starts on a MAT2ALIGN boundary where the allocator
+ * wrappers allow it; the kernels do not rely on this */
+static m2word *mat2Alloc(size_t nwords) {
+    size_t nb = nwords ? nwords * sizeof(m2word) : 1;
+#if !defined(USE_TCL_ALLOC) && !defined(USE_VERB_ALLOC) && !defined(_WIN32)
+    void *res;
+    if (0 != posix_memalign(&res, MAT2ALIGN / 8, nb)) return NULL;
+    memset(res, 0, nb);
+    return (m2word *) res;
+#else
+    return (m2word *) callox(nb, 1);
+#endif
+}
 
 int stdVGetEntry2(void *vec, int idx, int *val) {
     vec2 *v = (vec2 *) vec;
-    int off = idx/BITSPERINT, msk = 1 << (idx % BITSPERINT);
+    int off = idx/BITSPERWORD;
+    m2word msk = ((m2word) 1) << (idx % BITSPERWORD);
     if (idx >= (v->size)) return FAILIMPOSSIBLE;
     *val = (msk & v->data[off]) ? 1 : 0;
     return SUCCESS;
@@ -24,7 +243,8 @@ int stdVGetEntry2(void *vec, int idx, int *val) {
 
 int stdVSetEntry2(void *vec, int idx, int val) {
     vec2 *v = (vec2 *) vec;
-    int off = idx/BITSPERINT, msk = 1 << (idx % BITSPERINT);
+    int off = idx/BITSPERWORD;
+    m2word msk = ((m2word) 1) << (idx % BITSPERWORD);
     if (0 == (val & 0x1)) return SUCCESS;
     if (idx >= (v->size)) return FAILIMPOSSIBLE;
     if (val & 0x1) {
@@ -45,7 +265,7 @@ void *stdVCreateVector2(int cols) {
     if (NULL != v) {
         v->size = cols;
         v->ints = IPROCO(cols);
-        if (NULL == (v->data = (int*) callox(v->ints,sizeof(int)))) {
+        if (NULL == (v->data = (m2word*) callox(v->ints,sizeof(m2word)))) {
             freex(v);
             return NULL;
         }
@@ -59,11 +279,11 @@ void *stdVCreateCopy2(void *vec) {
     if (NULL != w) {
         w->size = v->size;
         w->ints = v->ints;
-        if (NULL == (w->data = (int*) mallox(v->ints))) {
+        if (NULL == (w->data = (m2word*) mallox(sizeof(m2word) * v->ints))) {
             freex(w);
             return NULL;
         }
-        memcpy(w,v,sizeof(int) * w->ints);
+        memcpy(w->data,v->data,sizeof(m2word) * w->ints);
     }
     return w;
 }
@@ -92,19 +312,21 @@ vectorType stdVectorType2 = {
 
 int stdGetEntry2(void *m, int row, int col, int *val) {
     mat2 *mat = (mat2 *) m;
-    unsigned int off = col/BITSPERINT, msk = (unsigned) 1 << (((unsigned) col) % BITSPERINT);
+    unsigned int off = col/BITSPERWORD;
+    m2word msk = ((m2word) 1) << (((unsigned) col) % BITSPERWORD);
     if ((row >= mat->rows) || (col >= mat->cols))
         return FAILIMPOSSIBLE;
-    *val = (mat->data[row*(mat->ipr)+off] & msk) ? 1 : 0;
+    *val = (mat->data[(size_t) row * mat->ipr + off] & msk) ? 1 : 0;
     return SUCCESS;
 }
 
 int stdSetEntry2(void *m, int row, int col, int val) {
     mat2 *mat = (mat2 *) m;
-    unsigned int off = col/BITSPERINT, msk = (unsigned) 1 << (((unsigned) col) % BITSPERINT);
+    size_t off = col/BITSPERWORD;
+    m2word msk = ((m2word) 1) << (((unsigned) col) % BITSPERWORD);
     if ((row >= mat->rows) || (col >= mat->cols))
         return FAILIMPOSSIBLE;
-    off += row*(mat->ipr);
+    off += (size_t) row * mat->ipr;
     if (val & 0x1) {
         mat->data[off] |= msk;
     } else {
@@ -115,12 +337,12 @@ int stdSetEntry2(void *m, int row, int col, int val) {
 
 int stdAddToEntry2(void *m, int row, int col, int val, int mod) {
     mat2 *mat = (mat2 *) m;
-    int off = col/BITSPERINT;
-    unsigned msk = ((unsigned)1) << (col % BITSPERINT);
+    size_t off = col/BITSPERWORD;
+    m2word msk = ((m2word) 1) << (col % BITSPERWORD);
     if ((row >= mat->rows) || (col >= mat->cols))
         return FAILIMPOSSIBLE;
     if (0 == (val & 0x1)) return SUCCESS;
-    off += row*(mat->ipr);
+    off += (size_t) row * mat->ipr;
     mat->data[off] ^= msk;
     return SUCCESS;
 }
@@ -131,10 +353,12 @@ void stdGetDimensions2(void *m, int *row, int *col) {
 }
 
 void *stdCreateMatrix2(int row, int col) {
-    mat2 *m = (mat2 *) mallox(sizeof(mat2));
+    mat2 *m;
+    if ((row < 0) || (col < 0)) return NULL;
+    m = (mat2 *) mallox(sizeof(mat2));
     if (NULL != m) {
         m->rows = row; m->cols = col; m->ipr = IPROCO(col);
-        if (NULL == (m->data = (int*) callox(row * m->ipr,sizeof(int)))) {
+        if (NULL == (m->data = mat2Alloc((size_t) row * m->ipr))) {
             freex(m);
             return NULL;
         }
@@ -146,14 +370,14 @@ void *stdCreateMCopy2(void *mat) {
     mat2 *m = (mat2 *) mat;
     mat2 *res = (mat2 *) stdCreateMatrix2(m->rows, m->cols);
     if (NULL != res && NULL != m->data) {
-        memcpy(res->data,m->data,m->ipr * m->rows * sizeof(int));
+        memcpy(res->data,m->data,(size_t) m->ipr * m->rows * sizeof(m2word));
     }
     return res;
 }
 
 int stdCopyRows2(void *dst, int start, void *src, int from, int nrows) {
   mat2 *d=(mat2*)dst, *s=(mat2*)src;
-  memcpy(d->data+start*d->ipr,s->data+from*s->ipr,s->ipr*nrows * sizeof(int));
+  memcpy(d->data+(size_t)start*d->ipr,s->data+(size_t)from*s->ipr,(size_t)s->ipr*nrows * sizeof(m2word));
   return 1;
 }
 
@@ -165,7 +389,7 @@ void stdDestroyMatrix2(void *mat) {
 
 void stdClearMatrix2(void *mat) {
     mat2 *m = (mat2 *) mat;
-    memset(m->data,0,sizeof(int) * m->ipr * m->rows);
+    memset(m->data,0,sizeof(m2word) * (size_t) m->ipr * m->rows);
 }
 
 void stdUnitMatrix2(void *mat) {
@@ -181,19 +405,22 @@ int stdReduceMatrix2(void *mat, int prime) {
 }
 
 // forward declarations
-mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel, const char *progvar, int pmsk);
-mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *progvar, int pmsk);
-int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, int pmsk);
+mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel, const char *progvar, int pmsk, int *interruptVar);
+mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *progvar, int pmsk, int *interruptVar);
+int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, int pmsk, int *interruptVar);
+int matrix_multiply2(mat2 *res, mat2 *a, mat2 *b);
+
+static int zero;
 
 void *stdOrthoFunc2(primeInfo *pi, void *inp, void *urb, int wantkernel, progressInfo *prg) {
     mat2 *ker;
     Tcl_Interp *ip = NULL;
     const char *progvar = NULL;
-    int pmsk = 0;
+    int pmsk = 0, *ivarp = NULL;
     if (NULL != prg) {
-        ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk;
+        ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk; ivarp = prg->interruptVar;
     }
-    ker = matrix_ortho2((mat2 *) inp, (mat2 **) urb, ip, wantkernel, progvar, pmsk);
+    ker = matrix_ortho2((mat2 *) inp, (mat2 **) urb, ip, wantkernel, progvar, pmsk, ivarp ? ivarp : &zero);
     return ker;
 }
 
@@ -201,46 +428,107 @@ void *stdLiftFunc2(primeInfo *pi, void *inp, void *lft, void *bas, progressInfo
     mat2 *res;
     Tcl_Interp *ip = NULL;
     const char *progvar = NULL;
-    int pmsk = 0;
-    if (NULL != prg) { ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk; }
-    res = matrix_lift2((mat2 *) inp, (mat2*)lft, (mat2*)bas, ip, progvar, pmsk);
+    int pmsk = 0, *ivarp = NULL;
+    if (NULL != prg) { ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk; ivarp = prg->interruptVar; }
+    res = matrix_lift2((mat2 *) inp, (mat2*)lft, (mat2*)bas, ip, progvar, pmsk, ivarp ? ivarp : &zero);
     return res;
 }
 
 void stdQuotFunc2(primeInfo *pi, void *ker, void *im, progressInfo *prg) {
     Tcl_Interp *ip = NULL;
     const char *progvar = NULL;
-    int pmsk = 0;
-    if (NULL != prg) { ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk; }
-    matrix_quotient2((mat2 *) ker, (mat2 *) im, ip, progvar, pmsk);
-}
-
-void vector_add2(int *a, int *b, int nint) {
-    while (nint--) *a++ ^= *b++;
+    int pmsk = 0, *ivarp = NULL;
+    if (NULL != prg) { ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk; ivarp = prg->interruptVar; }
+    matrix_quotient2((mat2 *) ker, (mat2 *) im, ip, progvar, pmsk, ivarp ? ivarp : &zero);
 }
 
 int stdAddMatrix2(void *m1, void *m2, int scale, int mod) {
     mat2 *x1 = (mat2 *) m1;
     mat2 *x2 = (mat2 *) m2;
+    int i;
     if (0 == (0x1 & scale)) return SUCCESS;
     if ((x1->rows != x2->rows) || (x1->cols != x2->cols))
         return FAILIMPOSSIBLE;
-    vector_add2(x1->data,x2->data,x1->ipr * x1->rows);
+    for (i = 0; i < x1->rows; i++)
+        vector_add2(x1->data + (size_t) i * x1->ipr,
+                    x2->data + (size_t) i * x1->ipr, x1->ipr);
     return SUCCESS;
 }
 
+int stdMultFunc2(void *res, void *m1, void *m2, int prime) {
+    if (2 != prime) return FAILIMPOSSIBLE;
+    return matrix_multiply2((mat2 *) res, (mat2 *) m1, (mat2 *) m2);
+}
+
+void *stdTransposeMatrix2(void *mat) {
+    mat2 *m = (mat2 *) mat, *res = (mat2 *) stdCreateMatrix2(m->cols, m->rows);
+    m2win src, dst;
+    if (NULL != res) {
+        d2Window(&src, m);
+        d2Window(&dst, res);
+        d2Transpose(&dst, &src);
+    }
+    return res;
+}
+
+void *stdExtractCols2(void *mat, int *idx, int num) {
+    mat2 *m = (mat2 *) mat, *res = (mat2 *) stdCreateMatrix2(m->rows, num);
+    m2win src, dst;
+    if (NULL != res) {
+        d2Window(&src, m);
+        d2Window(&dst, res);
+        if (SUCCESS != d2ExtractCols(&dst, &src, idx, num)) {
+            stdDestroyMatrix2(res);
+            res = NULL;
+        }
+    }
+    return res;
+}
+
 void *stdShrinkMatrix2(void *mat, int *indices, int numind) {
     mat2 *m = (mat2 *) mat;
     mat2 *res = (mat2*) stdCreateMatrix2(numind,m->cols);
     if (NULL != res) {
         int i, ipr = m->ipr;
         for (i=0;i<numind;i++) {
-            memcpy(res->data+i*ipr,m->data + *indices++ * ipr,ipr*sizeof(int));
+            memcpy(res->data+(size_t)i*ipr,m->data + (size_t)*indices++ * ipr,ipr*sizeof(m2word));
         }
     }
     return res;
 }
 
+/* the pseudo random generator of the OpenCL kernels: each row is made
+ * of 32 bit words that are computed independently */
+static unsigned int randomWord2(unsigned int row, unsigned int col,
+                                unsigned int seed, int rounds) {
+    unsigned int x = row * 0xdeadbeefu + seed + col;
+    x = (x ^ 61) ^ (x >> 16);
+    x *= 9;
+    x ^= x >> 4;
+    x *= 0x27d4eb2du;
+    x ^= x >> 15;
+    while (rounds-- > 0) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+    return x;
+}
+
+void *stdRandomMatrix2(int row, int col, int rounds, unsigned int seed) {
+    mat2 *m = (mat2 *) stdCreateMatrix2(row, col);
+    int i, c, nw = (col + 31) / 32;
+    if (NULL == m) return NULL;
+    for (i=0;i<row;i++) {
+        m2word *rw = m->data + (size_t) i * m->ipr;
+        for (c=0;c<nw;c++)
+            rw[c / 2] |= ((m2word) randomWord2(i, c, seed, rounds)) << (32 * (c & 1));
+        if (col % BITSPERWORD)
+            rw[col / BITSPERWORD] &= (((m2word) 1) << (col % BITSPERWORD)) - 1;
+    }
+    return m;
+}
+
 matrixType stdMatrixType2 = {
     .name          = "stdmatrix2",
     .getEntry      = stdGetEntry2,
@@ -258,7 +546,10 @@ matrixType stdMatrixType2 = {
     .orthoFunc     = stdOrthoFunc2,
     .liftFunc      = stdLiftFunc2,
     .quotFunc      = stdQuotFunc2,
-    .copyRows      = stdCopyRows2
+    .copyRows      = stdCopyRows2,
+    .multFunc      = stdMultFunc2,
+    .transpose     = stdTransposeMatrix2,
+    .extractCols   = stdExtractCols2
 };
 
 
@@ -273,26 +564,26 @@ matrixType stdMatrixType2 = {
 #define PROGVARDONE \
     if (NULL != progvar) Tcl_UnlinkVar(ip, progvar);
 
-#define LINALG_INTERRUPT_VARIABLE 0
+#define LINALG_INTERRUPT_VARIABLE (*interruptVar)
 
 void matrix_collect_ext2(mat2 *dst, mat2 *src, int i) {
-    int off1 = dst->rows * dst->ipr;
-    int off2 = i * src->ipr;
-    memcpy(dst->data + off1, src->data + off2, sizeof(int) * src->ipr);
+    size_t off1 = (size_t) dst->rows * dst->ipr;
+    size_t off2 = (size_t) i * src->ipr;
+    memcpy(dst->data + off1, src->data + off2, sizeof(m2word) * src->ipr);
     dst->rows++;
 }
 
 void matrix_collect2(mat2 *m, int i) {
-    int off1 = m->rows * m->ipr;
-    int off2 = i * m->ipr;
-    memcpy(m->data + off1, m->data + off2, sizeof(int) * m->ipr);
+    size_t off1 = (size_t) m->rows * m->ipr;
+    size_t off2 = (size_t) i * m->ipr;
+    memcpy(m->data + off1, m->data + off2, sizeof(m2word) * m->ipr);
     m->rows++;
 }
 
 int matrix_resize2(mat2 *m, int newrows) {
-    int nsz = m->ipr * sizeof(int) * newrows;
-    int *nw;
-    nw = (int*)reallox(m->data, nsz);
+    size_t nsz = (size_t) m->ipr * sizeof(m2word) * newrows;
+    m2word *nw;
+    nw = (m2word*)reallox(m->data, nsz);
     m->rows = newrows;
     if ((NULL!=nw) || (0 == nsz)) {
         m->data = nw;
@@ -301,17 +592,58 @@ int matrix_resize2(mat2 *m, int newrows) {
     return 1;
 }
 
-// forward declarations
+/* matrices with at least M4RIMINROWS rows to be reduced are handled by
+ * the Four Russians versions at the end of this file */
+#define M4RIMAXK    8
+#ifndef M4RIMINROWS
+#  define M4RIMINROWS 256
+#endif
+
+static mat2 *matrix_ortho2_m4ri(mat2 *inp, mat2 **urb, Tcl_Interp *ip,
+                                int wantkernel, const char *progvar, int pmsk,
+                                int *interruptVar);
+static mat2 *matrix_lift2_m4ri(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip,
+                               const char *progvar, int pmsk, int *interruptVar);
+static int matrix_quotient2_m4ri(mat2 *ker, mat2 *im, Tcl_Interp *ip,
+                                 const char *progvar, int pmsk, int *interruptVar);
+
+/* from PLEMINROWS rows on, the recursive block elimination of dense2.cc
+ * takes over; see the last section of this file. On current x86 cores it
+ * overtakes the m4ri code somewhere between 16384 and 32768 rows. The
+ * threshold can be changed at runtime through steenrod::_pleminrows. */
+#ifndef PLEMINROWS
+#  define PLEMINROWS 24576
+#endif
+
+int thepleminrows = PLEMINROWS;
+
+static mat2 *matrix_ortho2_ple(mat2 *inp, mat2 **urb, Tcl_Interp *ip,
+                               int wantkernel, const char *progvar, int pmsk,
+                               int *interruptVar);
+static int matrix_lift2_ple(mat2 *inp, mat2 *lft, mat2 *bas, mat2 **res,
+                            Tcl_Interp *ip, const char *progvar, int pmsk,
+                            int *interruptVar);
+static int matrix_quotient2_ple(mat2 *ker, mat2 *im, Tcl_Interp *ip,
+                                const char *progvar, int pmsk, int *interruptVar);
+
 mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel,
-                    const char *progvar, int pmsk) {
+                    const char *progvar, int pmsk, int *interruptVar) {
     int i, j, spr, uspr;
     int failure = 1;     /* pessimistic, eh? */
-    int *v1,*v2,*v3,*v4;
-    int *aux;
+    m2word *v1,*v2,*v3,*v4;
+    m2word *aux;
 
     mat2 m1, m2, m3;
     mat2 *un, *oth = NULL;
 
+    if (inp->rows >= thepleminrows)
+        return matrix_ortho2_ple(inp, urb, ip, wantkernel, progvar, pmsk,
+                                 interruptVar);
+
+    if (inp->rows >= M4RIMINROWS)
+        return matrix_ortho2_m4ri(inp, urb, ip, wantkernel, progvar, pmsk,
+                                  interruptVar);
+
     PROGVARINIT ;
 
     un = (mat2 *) stdCreateMatrix2(inp->rows, inp->rows);
@@ -350,21 +682,19 @@ mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel,
         }
 
         /* find pivot for this row */
-        for (aux=v1, j=spr; j; aux++, j--)
-            if (0 != *aux) break;
-
-        if (0 == j) {
+        if (0 > (j = vector_firstbit2(v1, spr))) {
             /* row is zero */
 	  if (wantkernel) matrix_collect2(&m2, i); /* collect kernel vector */
         } else {
-            unsigned int pivmsk = *aux; pivmsk ^= pivmsk & (pivmsk-1);
+            m2word pivmsk = ((m2word) 1) << (j % BITSPERWORD);
+            aux = v1 + j / BITSPERWORD;
             matrix_collect2(&m1, i); /* collect image vector */
             if (NULL != oth) {
                 matrix_collect_ext2(&m3, &m2, i);
             }
              /* go through all other rows and normalize */
             v2 = v1 + spr; aux += spr;
-            v3 = un->data + i * uspr;
+            v3 = un->data + (size_t) i * uspr;
             v4 = v3 + uspr;
             for (j=i+1; j<inp->rows; j++, v2+=spr, v4+=uspr, aux+=spr) {
                 if (0 != (*aux & pivmsk)) {
@@ -389,7 +719,7 @@ mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel,
 
     PROGVARDONE ;
 
-    if (!wantkernel) {
+    if (!wantkernel && (NULL != un)) {
         stdDestroyMatrix2(un);
         un = NULL;
     }
@@ -397,15 +727,24 @@ mat2 *matrix_ortho2(mat2 *inp, mat2 **urb, Tcl_Interp *ip, int wantkernel,
     return un;
 }
 
-mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *progvar, int pmsk) {
+mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *progvar, int pmsk, int *interruptVar) {
 
     int i, j, spr, uspr;
     int failure=1;
-    int *v1,*v2,*v3,*v4;
-    int *aux;
+    m2word *v1,*v2,*v3,*v4;
+    m2word *aux;
 
     mat2 *un, *res ;
 
+    /* the recursive version needs a basis in staircase form */
+    if (((NULL == bas ? inp->rows : 0) + lft->rows >= thepleminrows)
+        && (FAILUNTRUE != matrix_lift2_ple(inp, lft, bas, &res, ip, progvar,
+                                           pmsk, interruptVar)))
+        return res;
+
+    if ((NULL == bas ? inp->rows : 0) + lft->rows >= M4RIMINROWS)
+        return matrix_lift2_m4ri(inp, lft, bas, ip, progvar, pmsk, interruptVar);
+
     PROGVARINIT ;
 
     if(NULL == bas) {
@@ -435,14 +774,13 @@ mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *
             PROGVARSET(perc);
         }
         /* find pivot for this row */
-        for (aux=v1, j=spr; j; aux++, j--)
-            if (0 != *aux) break;
-        if (0 == j) {
+        if (0 > (j = vector_firstbit2(v1, spr))) {
             /* row is zero */
         } else {
-            unsigned int pivmsk = *aux; pivmsk ^= pivmsk & (pivmsk-1);
+            m2word pivmsk = ((m2word) 1) << (j % BITSPERWORD);
+            aux = v1 + j / BITSPERWORD;
             pos = aux - v1;
-	    v3 = un->data + i * uspr;
+	    v3 = un->data + (size_t) i * uspr;
 	    if(NULL == bas) {
 	      /* go through all other rows and normalize */
 	      v2 = v1 + spr; aux += spr;
@@ -481,12 +819,20 @@ mat2 *matrix_lift2(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip, const char *
     return res;
 }
 
-int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, int pmsk) {
+int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, int pmsk, int *interruptVar) {
   int i, j,  spr;
-    int *v1,*v2;
-    int *aux;
+    m2word *v1,*v2;
+    m2word *aux;
     mat2 m1;
 
+    if ((ker->rows >= thepleminrows)
+        && (FAILUNTRUE != (i = matrix_quotient2_ple(ker, im, ip, progvar, pmsk,
+                                                    interruptVar))))
+        return i;
+
+    if (ker->rows >= M4RIMINROWS)
+        return matrix_quotient2_m4ri(ker, im, ip, progvar, pmsk, interruptVar);
+
     PROGVARINIT ;
 
     /* m1 is used to collect quotient vectors from ker */
@@ -511,12 +857,11 @@ int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, i
             PROGVARSET(perc);
         }
         /* find pivot for this row */
-        for (aux=v1, j=spr; j; aux++, j--)
-            if (0 != *aux) break;
-        if (0 == j) {
+        if (0 > (j = vector_firstbit2(v1, spr))) {
             /* row is zero */ ASSERT(0=="row shouldn't be zero!");
         } else {
-            unsigned int pivmsk = *aux; pivmsk ^= pivmsk & (pivmsk-1);
+            m2word pivmsk = ((m2word) 1) << (j % BITSPERWORD);
+            aux = v1 + j / BITSPERWORD;
             pos = aux - v1;
             /* reduce vectors in ker in the usual way */
             v2 = ker->data; aux = v2 + pos;
@@ -535,12 +880,11 @@ int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, i
     for (v1=ker->data, i=0; i<ker->rows; i++, v1+=spr) {
         int pos;
         /* find pivot for this row */
-        for (aux=v1, j=spr; j; aux++, j--)
-            if (0 != *aux) break;
-        if (0 == j) {
+        if (0 > (j = vector_firstbit2(v1, spr))) {
             /* row is zero */
         } else {
-            unsigned int pivmsk = *aux; pivmsk ^= pivmsk & (pivmsk-1);
+            m2word pivmsk = ((m2word) 1) << (j % BITSPERWORD);
+            aux = v1 + j / BITSPERWORD;
             pos = aux - v1;
             matrix_collect2(&m1, i); /* collect this row */
             /* reduce other vectors in ker */
@@ -553,11 +897,647 @@ int matrix_quotient2(mat2 *ker, mat2 *im, Tcl_Interp *ip, const char *progvar, i
         }
     }
 
+
+ done:;
+
     PROGVARDONE ;
 
+    if (TCL_OK != matrix_resize2(ker, m1.rows)) return TCL_ERROR;
+
+    return SUCCESS;
+}
+
+/**** METHOD OF FOUR RUSSIANS ***********************************************/
+
+/* For large matrices the eliminations are done with pivot blocks of up
+ * to k rows. The pivot rows of a block are copied to a private buffer,
+ * together with their companion rows (base change or lift), and once the
+ * block is complete all later rows are reduced through a table of the
+ * 2^k combinations of its pivots; the table is built in Gray code order
+ * with one row addition per entry.
+ *
+ * Reducing a row by the pivots one after the other, as the functions
+ * above do, is a linear function of the row's bits in the pivot columns.
+ * We therefore determine the combination of pivot rows for unit vectors
+ * by simulating the row-by-row elimination, and get the same results as
+ * the plain elimination bit for bit, also for the base change matrices. */
+
+typedef struct {
+    int      k, kmax;            /* pivots in the current block, maximum */
+    int      w1, w2, w;          /* words per row: main part, companion, sum */
+    int      pos[M4RIMAXK];      /* word offsets of the pivots */
+    m2word   msk[M4RIMAXK];      /* bit masks of the pivots */
+    m2word  *rows;               /* the pivot rows, kmax rows of w words */
+    m2word  *tab;                /* the table, 2^kmax rows of w words */
+} m4rblock;
+
+static void m4rFree(m4rblock *b) {
+    if (NULL != b->rows) freex(b->rows);
+    if (NULL != b->tab) freex(b->tab);
+    b->rows = b->tab = NULL;
+}
+
+/* choose the block size; roughly log2(rows) - 2 */
+static int m4rChooseK(int rows) {
+    int k = 1;
+    while ((k < M4RIMAXK) && ((8 << k) <= rows)) k++;
+    return k;
+}
+
+static int m4rInit(m4rblock *b, int rows, int w1, int w2) {
+    b->k = 0; b->kmax = m4rChooseK(rows);
+    b->w1 = w1; b->w2 = w2; b->w = w1 + w2;
+    b->rows = (m2word *) mallox(sizeof(m2word) * b->kmax * b->w);
+    b->tab  = (m2word *) mallox(sizeof(m2word) * (1 << b->kmax) * b->w);
+    if ((NULL == b->rows) || (NULL == b->tab)) {
+        m4rFree(b);
+        return FAILMEM;
+    }
+    return SUCCESS;
+}
+
+/* make v1|v2 the next pivot of the block */
+static void m4rAddPivot(m4rblock *b, m2word *v1, m2word *v2, int bit) {
+    m2word *r = b->rows + b->k * b->w;
+    memcpy(r, v1, sizeof(m2word) * b->w1);
+    if (b->w2) memcpy(r + b->w1, v2, sizeof(m2word) * b->w2);
+    b->pos[b->k] = bit / BITSPERWORD;
+    b->msk[b->k] = ((m2word) 1) << (bit % BITSPERWORD);
+    b->k++;
+}
+
+/* reduce v1|v2 by the pivots of the current block, one after the other */
+static void m4rReduceRow(m4rblock *b, m2word *v1, m2word *v2) {
+    int t;
+    m2word *r;
+    for (t=0, r=b->rows; t<b->k; t++, r+=b->w)
+        if (v1[b->pos[t]] & b->msk[t]) {
+            vector_add2(v1, r, b->w1);
+            if (b->w2) vector_add2(v2, r + b->w1, b->w2);
+        }
+}
+
+static void m4rBuildTable(m4rblock *b) {
+    unsigned pat[M4RIMAXK], sel, v;
+    int s, t, g, w = b->w;
+    m2word *e;
+
+    /* pat[t] = the bits of pivot row t in the pivot columns */
+    for (t=0; t<b->k; t++) {
+        m2word *r = b->rows + t * w;
+        for (pat[t]=0, s=0; s<b->k; s++)
+            if (r[b->pos[s]] & b->msk[s]) pat[t] |= 1u << s;
+    }
+
+    /* the combination that the elimination chooses for unit vectors */
+    for (s=0; s<b->k; s++) {
+        for (v = 1u << s, sel = 0, t=0; t<b->k; t++)
+            if (v & (1u << t)) {
+                v ^= pat[t];
+                sel ^= 1u << t;
+            }
+        e = b->tab + (1 << s) * w;
+        memset(e, 0, sizeof(m2word) * w);
+        for (t=0; t<b->k; t++)
+            if (sel & (1u << t)) vector_add2(e, b->rows + t * w, w);
+    }
+
+    /* all other combinations in Gray code order */
+    for (g=1; g < (1 << b->k); g++) {
+        unsigned c = g ^ (g >> 1), p = (g - 1) ^ ((g - 1) >> 1), d = c ^ p;
+        m2word *tc = b->tab + c * w;
+        if (0 == (c & (c - 1))) continue;
+        memcpy(tc, b->tab + p * w, sizeof(m2word) * w);
+        vector_add2(tc, b->tab + d * w, w);
+    }
+}
+
+/* reduce v1|v2 by the complete block */
+static inline void m4rApply(m4rblock *b, m2word *v1, m2word *v2) {
+    unsigned idx = 0;
+    int t;
+    m2word *e;
+    for (t=0; t<b->k; t++)
+        if (v1[b->pos[t]] & b->msk[t]) idx |= 1u << t;
+    if (0 == idx) return;
+    e = b->tab + idx * b->w;
+    vector_add2(v1, e, b->w1);
+    if (b->w2) vector_add2(v2, e + b->w1, b->w2);
+}
+
+/* Reducing the remaining rows by a complete block is where the time goes.
+ * The rows are independent of each other, so large batches are split
+ * into parallelThreads() consecutive parts that are done concurrently;
+ * the block itself is only read. */
+
+#ifndef M4RPARMIN
+#  define M4RPARMIN (1 << 15) /* words to reduce before threads are used */
+#endif
+
+typedef struct {
+    m4rblock *b;
+    m2word   *d1, *d2;           /* first row of the main and companion part */
+    int       s1, s2;            /* words per row */
+    int       rows, njobs;
+} m4rApplyJob;
+
+static void m4rApplyPart(void *cd, int job) {
+    m4rApplyJob *aj = (m4rApplyJob *) cd;
+    int j  = (int) (((long long) aj->rows * job) / aj->njobs);
+    int to = (int) (((long long) aj->rows * (job + 1)) / aj->njobs);
+    for (; j<to; j++)
+        m4rApply(aj->b, aj->d1 + (size_t) j * aj->s1,
+                 (NULL != aj->d2) ? aj->d2 + (size_t) j * aj->s2 : NULL);
+}
+
+/* reduce the rows from,...,to-1 of m1|m2 by the block; m2 may be NULL */
+static void m4rApplyRows(m4rblock *b, mat2 *m1, mat2 *m2, int from, int to) {
+    m4rApplyJob aj;
+    int nthr;
+    if (from >= to) return;
+    aj.b = b; aj.rows = to - from;
+    aj.s1 = m1->ipr; aj.d1 = m1->data + (size_t) from * aj.s1;
+    aj.s2 = 0; aj.d2 = NULL;
+    if (NULL != m2) {
+        aj.s2 = m2->ipr; aj.d2 = m2->data + (size_t) from * aj.s2;
+    }
+    aj.njobs = 1;
+    if (((long long) aj.rows * b->w >= M4RPARMIN)
+        && (1 < (nthr = parallelThreads())))
+        aj.njobs = MIN(nthr, aj.rows);
+    parallelRun(aj.njobs, m4rApplyPart, &aj);
+}
+
+static mat2 *matrix_ortho2_m4ri(mat2 *inp, mat2 **urb, Tcl_Interp *ip,
+                                int wantkernel, const char *progvar, int pmsk,
+                                int *interruptVar) {
+    int i, spr, uspr, piv;
+    int failure = 1;
+    m2word *v1, *v3;
+    m4rblock blk;
+
+    mat2 m1, m2, m3;
+    mat2 *un, *oth = NULL;
+
+    PROGVARINIT ;
+
+    un = (mat2 *) stdCreateMatrix2(inp->rows, inp->rows);
+    if (NULL == un) return NULL;
+    stdUnitMatrix2(un);
+
+    if (urb) {
+        oth = (*urb = (mat2*) stdCreateMatrix2(inp->rows, inp->rows));
+        if (NULL == oth) {
+            stdDestroyMatrix2(un);
+            return NULL;
+        }
+    }
+
+    spr = inp->ipr;
+    uspr = un->ipr;
+
+    if (SUCCESS != m4rInit(&blk, inp->rows, spr, uspr)) {
+        stdDestroyMatrix2(un);
+        if (NULL != oth) { stdDestroyMatrix2(oth); *urb = NULL; }
+        return NULL;
+    }
+
+    m1.ipr = inp->ipr;
+    m1.cols = inp->cols; m1.data = inp->data; m1.rows = 0;
+    m2.ipr = un->ipr;
+    m2.cols = un->cols;  m2.data = un->data;  m2.rows = 0;
+    if (oth != NULL) {
+        m3.cols = oth->cols;
+        m3.data = oth->data;  m3.ipr = oth->ipr;  m3.rows = 0;
+    }
+
+    for (v1=inp->data, v3=un->data, i=0; i<inp->rows; i++, v1+=spr, v3+=uspr) {
+
+        if ((NULL != progvar) && (0==(i&pmsk))) {
+            perc = i; perc /= inp->rows;
+            perc = 1-perc; perc *= perc; perc = 1-perc;
+            PROGVARSET(perc);
+        }
+
+        m4rReduceRow(&blk, v1, v3);
+
+        if (0 > (piv = vector_firstbit2(v1, spr))) {
+            if (wantkernel) matrix_collect2(&m2, i);
+            continue;
+        }
+
+        matrix_collect2(&m1, i);
+        if (NULL != oth) matrix_collect_ext2(&m3, &m2, i);
+        m4rAddPivot(&blk, v1, v3, piv);
+
+        if (blk.k == blk.kmax) {
+            m4rBuildTable(&blk);
+            m4rApplyRows(&blk, inp, un, i+1, inp->rows);
+            blk.k = 0;
+        }
+    }
+
+    failure = 0;
+
+ done:
+    m4rFree(&blk);
+
+    if (failure) {
+        stdDestroyMatrix2(un);
+        un = NULL;
+    } else {
+        if (TCL_OK != matrix_resize2(inp, m1.rows)) return NULL;
+        if (wantkernel && (TCL_OK != matrix_resize2(un, m2.rows))) return NULL;
+        if ((NULL != oth) && (TCL_OK != matrix_resize2(oth, m3.rows))) return NULL;
+    }
+
+    PROGVARDONE ;
+
+    if (!wantkernel && (NULL != un)) {
+        stdDestroyMatrix2(un);
+        un = NULL;
+    }
+
+    return un;
+}
+
+static mat2 *matrix_lift2_m4ri(mat2 *inp, mat2 *lft, mat2 *bas, Tcl_Interp *ip,
+                               const char *progvar, int pmsk, int *interruptVar) {
+    int i, spr, uspr, piv;
+    int failure = 1;
+    m2word *v1, *v3;
+    m4rblock blk;
+
+    mat2 *un, *res;
+
+    PROGVARINIT ;
+
+    if (NULL == bas) {
+        un = (mat2 *) stdCreateMatrix2(inp->rows, inp->rows);
+        if (NULL == un) return NULL;
+        stdUnitMatrix2(un);
+    } else {
+        un = bas;
+    }
+
+    res = (mat2 *) stdCreateMatrix2(lft->rows, un->cols);
+    if (NULL == res) {
+        if (un != bas) stdDestroyMatrix2(un);
+        return NULL;
+    }
+
+    spr = inp->ipr;
+    uspr = un->ipr;
+
+    if (SUCCESS != m4rInit(&blk, inp->rows + lft->rows, spr, uspr)) {
+        if (un != bas) stdDestroyMatrix2(un);
+        stdDestroyMatrix2(res);
+        return NULL;
+    }
+
+    for (v1=inp->data, v3=un->data, i=0; i<inp->rows; i++, v1+=spr, v3+=uspr) {
+
+        if ((NULL != progvar) && (0==(i&pmsk))) {
+            perc = i; perc /= inp->rows;
+            perc = 1-perc; perc *= perc; perc = 1-perc;
+            PROGVARSET(perc);
+        }
+
+        /* with a given basis the rows of inp are left alone */
+        if (NULL == bas) m4rReduceRow(&blk, v1, v3);
+
+        if (0 <= (piv = vector_firstbit2(v1, spr)))
+            m4rAddPivot(&blk, v1, v3, piv);
+
+        if ((blk.k == blk.kmax) || ((blk.k > 0) && (i == inp->rows - 1))) {
+            m4rBuildTable(&blk);
+            if (NULL == bas)
+                m4rApplyRows(&blk, inp, un, i+1, inp->rows);
+            m4rApplyRows(&blk, lft, res, 0, lft->rows);
+            blk.k = 0;
+        }
+    }
+
+    failure = 0;
+ done:
+    m4rFree(&blk);
+
+    PROGVARDONE ;
+
+    if (un != bas) stdDestroyMatrix2(un);
+
+    if (failure) {
+        stdDestroyMatrix2(res);
+        res = NULL;
+    }
+
+    return res;
+}
+
+static int matrix_quotient2_m4ri(mat2 *ker, mat2 *im, Tcl_Interp *ip,
+                                 const char *progvar, int pmsk, int *interruptVar) {
+    int i, spr, piv;
+    m2word *v1;
+    m4rblock blk;
+    mat2 m1;
+
+    PROGVARINIT ;
+
+    m1.data = ker->data; m1.ipr = ker->ipr;
+    m1.cols = ker->cols; m1.rows= 0;
+
+    if (0 == im->rows) im->cols = ker->cols;
+
+    spr = im->ipr;
+
+    if (SUCCESS != m4rInit(&blk, ker->rows, spr, 0)) {
+        PROGVARDONE ;
+        return FAILMEM;
+    }
+
+    /* reduce ker by the rows of im */
+    for (v1=im->data, i=0; i<im->rows; i++, v1+=spr) {
+        if ((NULL != progvar) && (0==(i&pmsk))) {
+            perc = i; perc /= im->rows;
+            perc = 1-perc; perc *= perc; perc = 1-perc;
+            PROGVARSET(perc);
+        }
+        if (0 > (piv = vector_firstbit2(v1, spr))) {
+            ASSERT(0=="row shouldn't be zero!");
+        } else {
+            m4rAddPivot(&blk, v1, NULL, piv);
+        }
+        if ((blk.k == blk.kmax) || ((blk.k > 0) && (i == im->rows - 1))) {
+            m4rBuildTable(&blk);
+            m4rApplyRows(&blk, ker, NULL, 0, ker->rows);
+            blk.k = 0;
+        }
+    }
+
+    /* now reduce ker and collect results */
+
+    PROGVARSET(-1.0);
+
+    for (v1=ker->data, i=0; i<ker->rows; i++, v1+=spr) {
+        m4rReduceRow(&blk, v1, NULL);
+        if (0 > (piv = vector_firstbit2(v1, spr))) continue;
+        matrix_collect2(&m1, i);
+        m4rAddPivot(&blk, v1, NULL, piv);
+        if (blk.k == blk.kmax) {
+            m4rBuildTable(&blk);
+            m4rApplyRows(&blk, ker, NULL, i+1, ker->rows);
+            blk.k = 0;
+        }
+    }
+
+
  done:;
 
+    PROGVARDONE ;
+
+    m4rFree(&blk);
+
     if (TCL_OK != matrix_resize2(ker, m1.rows)) return TCL_ERROR;
 
     return SUCCESS;
 }
+
+/**** RECURSIVE BLOCK ELIMINATION *******************************************/
+
+/* For very large matrices the rows are split in halves recursively, and
+ * the lower half is reduced by all pivots of the upper one with a single
+ * matrix product (see d2Reduce). With Strassen-Winograd for the products
+ * this is asymptotically faster than the row by row elimination, but it
+ * gives the same results, including the base change matrices. */
+
+typedef struct {
+    Tcl_Interp *ip;
+    const char *progvar;
+    int         pmsk, rows, *interruptVar;
+    double      perc;
+} pleProgress;
+
+static void pleProgressInit(pleProgress *pp, Tcl_Interp *ip, const char *progvar,
+                            int pmsk, int *interruptVar) {
+    pp->ip = ip; pp->progvar = progvar; pp->pmsk = pmsk;
+    pp->interruptVar = interruptVar;
+    pp->rows = 1; pp->perc = 0;
+    if (NULL != progvar)
+        Tcl_LinkVar(ip, progvar, (char *) &(pp->perc), TCL_LINK_DOUBLE);
+}
+
+static void pleProgressDone(pleProgress *pp) {
+    if (NULL != pp->progvar) Tcl_UnlinkVar(pp->ip, pp->progvar);
+}
+
+static int pleRowFunc(void *cd, int i) {
+    pleProgress *pp = (pleProgress *) cd;
+    if ((NULL != pp->progvar) && (0 == (i & pp->pmsk))) {
+        pp->perc = i; pp->perc /= pp->rows;
+        pp->perc = 1 - pp->perc; pp->perc *= pp->perc; pp->perc = 1 - pp->perc;
+        Tcl_UpdateLinkedVar(pp->ip, pp->progvar);
+    }
+    return *(pp->interruptVar);
+}
+
+static mat2 *matrix_ortho2_ple(mat2 *inp, mat2 **urb, Tcl_Interp *ip,
+                               int wantkernel, const char *progvar, int pmsk,
+                               int *interruptVar) {
+    int i, t, npiv, rc, *pivrow;
+    m2win a, c;
+    pleProgress pp;
+
+    mat2 m1, m2, m3;
+    mat2 *un, *oth = NULL;
+
+    un = (mat2 *) stdCreateMatrix2(inp->rows, inp->rows);
+    if (NULL == un) return NULL;
+    stdUnitMatrix2(un);
+
+    if (urb) {
+        oth = (*urb = (mat2*) stdCreateMatrix2(inp->rows, inp->rows));
+        if (NULL == oth) {
+            stdDestroyMatrix2(un);
+            return NULL;
+        }
+    }
+
+    if (NULL == (pivrow = (int *) mallox(2 * sizeof(int) * (inp->rows + 1)))) {
+        stdDestroyMatrix2(un);
+        if (NULL != oth) { stdDestroyMatrix2(oth); *urb = NULL; }
+        return NULL;
+    }
+
+    pleProgressInit(&pp, ip, progvar, pmsk, interruptVar);
+    pp.rows = inp->rows;
+
+    d2Window(&a, inp);
+    d2Window(&c, un);
+    rc = d2Eliminate(&a, &c, 1, pivrow, pivrow + inp->rows + 1, &npiv,
+                     pleRowFunc, &pp);
+
+    pleProgressDone(&pp);
+
+    if (SUCCESS != rc) {
+        freex(pivrow);
+        stdDestroyMatrix2(un);
+        return NULL;
+    }
+
+    /* collect image, kernel and base change in the usual way */
+    m1.ipr = inp->ipr;
+    m1.cols = inp->cols; m1.data = inp->data; m1.rows = 0;
+    m2.ipr = un->ipr;
+    m2.cols = un->cols;  m2.data = un->data;  m2.rows = 0;
+    if (oth != NULL) {
+        m3.cols = oth->cols;
+        m3.data = oth->data;  m3.ipr = oth->ipr;  m3.rows = 0;
+    }
+
+    for (t=i=0; i<inp->rows; i++) {
+        if ((t < npiv) && (pivrow[t] == i)) {
+            t++;
+            matrix_collect2(&m1, i);
+            if (NULL != oth) matrix_collect_ext2(&m3, &m2, i);
+        } else if (wantkernel) {
+            matrix_collect2(&m2, i);
+        }
+    }
+
+    freex(pivrow);
+
+    if (TCL_OK != matrix_resize2(inp, m1.rows)) return NULL;
+    if (wantkernel && (TCL_OK != matrix_resize2(un, m2.rows))) return NULL;
+    if ((NULL != oth) && (TCL_OK != matrix_resize2(oth, m3.rows))) return NULL;
+
+    if (!wantkernel) {
+        stdDestroyMatrix2(un);
+        un = NULL;
+    }
+
+    return un;
+}
+
+/* returns FAILUNTRUE, without touching anything, if bas is given but
+ * inp is not in staircase form */
+static int matrix_lift2_ple(mat2 *inp, mat2 *lft, mat2 *bas, mat2 **res,
+                            Tcl_Interp *ip, const char *progvar, int pmsk,
+                            int *interruptVar) {
+    int npiv, rc = SUCCESS, *pivrow, *pivpos;
+    m2win a, c, l, r;
+    pleProgress pp;
+    mat2 *un;
+
+    *res = NULL;
+
+    if (NULL == (pivrow = (int *) mallox(2 * sizeof(int) * (inp->rows + 1))))
+        return FAILMEM;
+    pivpos = pivrow + inp->rows + 1;
+
+    d2Window(&a, inp);
+
+    if (NULL != bas) {
+        if (SUCCESS != (rc = d2Staircase(&a, pivrow, pivpos, &npiv))) {
+            freex(pivrow);
+            return rc;
+        }
+        un = bas;
+    } else {
+        if (NULL == (un = (mat2 *) stdCreateMatrix2(inp->rows, inp->rows))) {
+            freex(pivrow);
+            return FAILMEM;
+        }
+        stdUnitMatrix2(un);
+    }
+
+    if (NULL == (*res = (mat2 *) stdCreateMatrix2(lft->rows, un->cols)))
+        rc = FAILMEM;
+
+    d2Window(&c, un);
+
+    if ((SUCCESS == rc) && (NULL == bas)) {
+        pleProgressInit(&pp, ip, progvar, pmsk, interruptVar);
+        pp.rows = inp->rows;
+        rc = d2Eliminate(&a, &c, 1, pivrow, pivpos, &npiv, pleRowFunc, &pp);
+        pleProgressDone(&pp);
+    }
+
+    if (SUCCESS == rc) {
+        d2Window(&l, lft);
+        d2Window(&r, *res);
+        rc = d2Reduce(&l, &r, &a, &c, un->ipr, pivrow, pivpos, npiv);
+    }
+
+    freex(pivrow);
+    if (un != bas) stdDestroyMatrix2(un);
+
+    if ((SUCCESS != rc) && (NULL != *res)) {
+        stdDestroyMatrix2(*res);
+        *res = NULL;
+    }
+
+    /* the caller must not fall back to the other versions any more */
+    return (FAILUNTRUE == rc) ? FAILIMPOSSIBLE : rc;
+}
+
+/* returns FAILUNTRUE, without touching anything, if im is not in
+ * staircase form */
+static int matrix_quotient2_ple(mat2 *ker, mat2 *im, Tcl_Interp *ip,
+                                const char *progvar, int pmsk, int *interruptVar) {
+    int t, npiv, rc, *pivrow, *pivpos, n = MAX(ker->rows, im->rows) + 1;
+    m2win k, m;
+    pleProgress pp;
+    mat2 m1;
+
+    if (0 == im->rows) im->cols = ker->cols;
+
+    if (NULL == (pivrow = (int *) mallox(2 * sizeof(int) * n)))
+        return FAILMEM;
+    pivpos = pivrow + n;
+
+    d2Window(&m, im);
+    d2Window(&k, ker);
+
+    if (SUCCESS != (rc = d2Staircase(&m, pivrow, pivpos, &npiv))) {
+        freex(pivrow);
+        return rc;
+    }
+
+    pleProgressInit(&pp, ip, progvar, pmsk, interruptVar);
+    pp.rows = ker->rows;
+
+    /* reduce ker by the rows of im, then by itself */
+    rc = d2Reduce(&k, NULL, &m, NULL, 0, pivrow, pivpos, npiv);
+    if (SUCCESS == rc)
+        rc = d2Eliminate(&k, NULL, 0, pivrow, pivpos, &npiv, pleRowFunc, &pp);
+
+    pleProgressDone(&pp);
+
+    if (SUCCESS == rc) {
+        m1.data = ker->data; m1.ipr = ker->ipr;
+        m1.cols = ker->cols; m1.rows= 0;
+        for (t=0; t<npiv; t++)
+            matrix_collect2(&m1, pivrow[t]);
+        if (TCL_OK != matrix_resize2(ker, m1.rows)) rc = FAILMEM;
+    }
+
+    freex(pivrow);
+
+    return (FAILUNTRUE == rc) ? FAILIMPOSSIBLE : rc;
+}
+
+/**** MULTIPLICATION ********************************************************/
+
+int matrix_multiply2(mat2 *res, mat2 *a, mat2 *b) {
+    m2win A, B, C;
+
+    if ((a->cols != b->rows) || (res->rows != a->rows) || (res->cols != b->cols))
+        return FAILIMPOSSIBLE;
+
+    /* the padding of the rows of a is zero, and so is that of b */
+    d2Window(&A, a);
+    d2Window(&B, b);
+    d2Window(&C, res);
+
+    return d2MultiplyParallel(&C, &A, &B, 0);
+}
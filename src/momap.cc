@@ -16,6 +16,7 @@
 #include <tcl.h>
 #include "setresult.h"
 #include <string.h>
+#include <limits.h>
 #include "tprime.h"
 #include "tpoly.h"
 #include "momap.h"
@@ -27,8 +28,7 @@ static Tcl_HashKeyType MomaHashType;
 /* cast from (Tcl_HashEntry *) to our (const exmo *) key */
 #define keyFromHE(he) ((Tcl_Obj *) (he)->key.objPtr)
 
-unsigned int momaHashProc(Tcl_HashTable *table, void *key) {
-    exmo *ex = exmoFromTclObj((Tcl_Obj *) key);
+static unsigned int exmoHash(const exmo *ex) {
     int res, cnt;
 
     res = ex->gen + 17*(ex->ext);
@@ -38,6 +38,10 @@ unsigned int momaHashProc(Tcl_HashTable *table, void *key) {
     return res;
 }
 
+unsigned int momaHashProc(Tcl_HashTable *table, void *key) {
+    return exmoHash(exmoFromTclObj((Tcl_Obj *) key));
+}
+
 int momaCompProc(void *keyPtr, Tcl_HashEntry *hPtr) {
     exmo *e1 = exmoFromTclObj((Tcl_Obj *) keyPtr);
     exmo *e2 = exmoFromTclObj((Tcl_Obj *) keyFromHE(hPtr));
@@ -118,6 +122,192 @@ int momapSetValPtr(momap *mo, Tcl_Obj *key, Tcl_Obj *val) {
     return SUCCESS;
 }
 
+/**** ACCUMULATORS **********************************************************/
+
+#define ACCUMINSLOTS 64
+
+accumulator *accuCreate(int modulo) {
+    accumulator *acc = (accumulator *) callox(1, sizeof(accumulator));
+    if (NULL == acc) return NULL;
+    acc->modulo = modulo;
+    return acc;
+}
+
+void accuReset(accumulator *acc) {
+    int i;
+    acc->num = 0;
+    for (i=0;i<acc->nslots;i++) acc->slots[i] = -1;
+}
+
+void accuDestroy(accumulator *acc) {
+    if (NULL != acc->dat) freex(acc->dat);
+    if (NULL != acc->slots) freex(acc->slots);
+    freex(acc);
+}
+
+/* slot where ex is found, or the free slot where it should go */
+static int accuFindSlot(accumulator *acc, const exmo *ex) {
+    unsigned int h = exmoHash(ex) * 0x9e3779b1u;
+    int msk = acc->nslots - 1, idx;
+    for (h = (h ^ (h >> 16)) & msk;; h = (h + 1) & msk) {
+        idx = acc->slots[h];
+        if ((idx < 0) || (0 == compareExmo(ex, &(acc->dat[idx]))))
+            return h;
+    }
+}
+
+/* drop vanished summands and rebuild the table with room for at
+ * least as many new summands as there are old ones, and for extra */
+static int accuRehash(accumulator *acc, int extra) {
+    int i, k, nslots, *slots;
+
+    for (k=i=0;i<acc->num;i++)
+        if (0 != acc->dat[i].coeff) {
+            if (k != i) copyExmo(&(acc->dat[k]), &(acc->dat[i]));
+            k++;
+        }
+    acc->num = k;
+
+    for (nslots = ACCUMINSLOTS;
+         (nslots < 4 * (k + 1)) || (nslots < 2 * (k + extra)); nslots <<= 1) ;
+
+    if (nslots != acc->nslots) {
+        if (NULL == (slots = (int *) mallox(nslots * sizeof(int))))
+            return FAILMEM;
+        if (NULL != acc->slots) freex(acc->slots);
+        acc->slots = slots;
+        acc->nslots = nslots;
+    }
+
+    for (i=0;i<nslots;i++) acc->slots[i] = -1;
+    for (i=0;i<k;i++) acc->slots[accuFindSlot(acc, &(acc->dat[i]))] = i;
+
+    return SUCCESS;
+}
+
+static int accuAddExmo(accumulator *acc, const exmo *ex, long long scale) {
+    long long c = scale * ex->coeff;
+    int h, idx;
+
+    if (acc->modulo) c %= acc->modulo;
+    if (0 == c) return SUCCESS;
+
+    if (2 * (acc->num + 1) > acc->nslots)
+        if (SUCCESS != accuRehash(acc, 0)) return FAILMEM;
+
+    h = accuFindSlot(acc, ex);
+    if (0 <= (idx = acc->slots[h])) {
+        c += acc->dat[idx].coeff;
+        if (acc->modulo) c %= acc->modulo;
+        else if ((c > INT_MAX) || (c < INT_MIN)) return FAILOVERFLOW;
+        acc->dat[idx].coeff = (int) c;
+        return SUCCESS;
+    }
+
+    if ((c > INT_MAX) || (c < INT_MIN)) return FAILOVERFLOW;
+
+    if (acc->num == acc->nalloc) {
+        int nalloc = acc->nalloc + (acc->nalloc >> 1) + ACCUMINSLOTS;
+        exmo *dat = (exmo *) reallox(acc->dat, nalloc * sizeof(exmo));
+        if (NULL == dat) return FAILMEM;
+        acc->dat = dat;
+        acc->nalloc = nalloc;
+    }
+
+    copyExmo(&(acc->dat[acc->num]), ex);
+    acc->dat[acc->num].coeff = (int) c;
+    acc->slots[h] = acc->num++;
+
+    return SUCCESS;
+}
+
+/* make room for n new summands, so that adding them neither rehashes
+ * nor moves the summands */
+static int accuReserve(accumulator *acc, int n) {
+    if (2 * (acc->num + n) > acc->nslots)
+        if (SUCCESS != accuRehash(acc, n)) return FAILMEM;
+
+    if (acc->num + n > acc->nalloc) {
+        int nalloc = acc->num + n;
+        exmo *dat = (exmo *) reallox(acc->dat, nalloc * sizeof(exmo));
+        if (NULL == dat) return FAILMEM;
+        acc->dat = dat;
+        acc->nalloc = nalloc;
+    }
+
+    return SUCCESS;
+}
+
+/* undo a successful accuAddExmo(acc, ex, scale). There must not have
+ * been a rehash since, so the slot of ex is still there; this neither
+ * allocates nor inserts, and cannot fail. */
+static void accuTakeBack(accumulator *acc, const exmo *ex, long long scale) {
+    long long c = scale * ex->coeff;
+    int idx;
+
+    if (acc->modulo) c %= acc->modulo;
+    if (0 == c) return;
+
+    idx = acc->slots[accuFindSlot(acc, ex)];
+    c = acc->dat[idx].coeff - c;
+    if (acc->modulo) c %= acc->modulo;
+    acc->dat[idx].coeff = (int) c;
+}
+
+int accuAddPoly(accumulator *acc, polyType *tp, void *pol, int scale) {
+    exmo *dat, aux;
+    int i, num, rcode = SUCCESS;
+
+    /* with room for all summands reserved the loops below cannot
+     * rehash, so a failure can be rolled back with accuTakeBack */
+    if (SUCCESS != accuReserve(acc, PLgetNumsum(tp, pol)))
+        return FAILMEM;
+
+    if (SUCCESS == PLgetSummandArray(tp, pol, &dat, &num)) {
+        for (i=0;i<num;i++)
+            if (SUCCESS != (rcode = accuAddExmo(acc, &(dat[i]), scale)))
+                break;
+        if (SUCCESS != rcode)
+            while (i--)
+                accuTakeBack(acc, &(dat[i]), scale);
+        return rcode;
+    }
+
+    num = PLgetNumsum(tp, pol);
+    for (i=0;i<num;i++) {
+        if (SUCCESS != (rcode = PLgetExmo(tp, pol, &aux, i)))
+            break;
+        if (SUCCESS != (rcode = accuAddExmo(acc, &aux, scale)))
+            break;
+    }
+    if (SUCCESS != rcode)
+        while (i--)
+            if (SUCCESS == PLgetExmo(tp, pol, &aux, i))
+                accuTakeBack(acc, &aux, scale);
+
+    return rcode;
+}
+
+void *accuSnapshot(accumulator *acc) {
+    void *res = (stdpoly->createCopy)(NULL);
+    int i;
+
+    if (NULL == res) return NULL;
+
+    if (SUCCESS != stdRealloc(res, acc->num)) {
+        (stdpoly->free)(res);
+        return NULL;
+    }
+
+    for (i=0;i<acc->num;i++)
+        if (0 != acc->dat[i].coeff)
+            PLappendExmo(stdpoly, res, &(acc->dat[i]));
+
+    PLcancel(stdpoly, res, acc->modulo);
+
+    return res;
+}
+
 /**** TCL INTERFACE **********************************************************/
 
 #define RETERR(errmsg) \
@@ -194,6 +384,8 @@ int Tcl_MomaWidgetCmd(ClientData cd, Tcl_Interp *ip,
                     auxptr= Tcl_DuplicateObj(auxptr);
                     momapSetValPtr(mo, objv[2], auxptr);
                 }
+                if (NULL == polyTypeFromTclObj(auxptr)->appendExmo)
+                    Tcl_PolyObjConvert(auxptr, stdpoly);
                 Tcl_InvalidateStringRep(auxptr);
                 if (SUCCESS != PLappendPoly(polyTypeFromTclObj(auxptr),
                                             polyFromTclObj(auxptr),
@@ -300,6 +492,101 @@ int Tcl_CreateMomaCmd(ClientData cd, Tcl_Interp *ip,
     return TCL_OK;
 }
 
+typedef enum { ACCADD, ACCSNAPSHOT, ACCRESET } acccmdcode;
+
+static const char *accCmdNames[] = { "add", "snapshot", "reset",
+                                     (char *) NULL };
+
+static acccmdcode accCmdmap[] = { ACCADD, ACCSNAPSHOT, ACCRESET };
+
+int Tcl_AccuWidgetCmd(ClientData cd, Tcl_Interp *ip,
+                      int objc, Tcl_Obj * const objv[]) {
+    accumulator *acc = (accumulator *) cd;
+    int result, index, scale;
+    void *pol;
+
+    if (objc < 2) {
+        Tcl_WrongNumArgs(ip, 1, objv, "subcommand ?args?");
+        return TCL_ERROR;
+    }
+
+    result = Tcl_GetIndexFromObj(ip, objv[1], accCmdNames, "subcommand", 0, &index);
+    if (result != TCL_OK) return result;
+
+    switch (accCmdmap[index]) {
+        case ACCADD:
+            scale = 1;
+            if ((objc < 3) || (objc > 4)) {
+                Tcl_WrongNumArgs(ip, 2, objv, "<polynomial> ?scale?");
+                return TCL_ERROR;
+            }
+            if (objc > 3)
+                if (TCL_OK != Tcl_GetIntFromObj(ip, objv[3], &scale))
+                    return TCL_ERROR;
+            if (TCL_OK != Tcl_ConvertToPoly(ip, objv[2]))
+                return TCL_ERROR;
+            switch (accuAddPoly(acc, polyTypeFromTclObj(objv[2]),
+                                polyFromTclObj(objv[2]), scale)) {
+                case SUCCESS:
+                    break;
+                case FAILOVERFLOW:
+                    RETERR("coefficient overflow");
+                default:
+                    RETERR("out of memory");
+            }
+            return TCL_OK;
+
+        case ACCSNAPSHOT:
+            if (objc != 2) {
+                Tcl_WrongNumArgs(ip, 2, objv, NULL);
+                return TCL_ERROR;
+            }
+            if (NULL == (pol = accuSnapshot(acc)))
+                RETERR("out of memory");
+            Tcl_SetObjResult(ip, Tcl_NewPolyObj(stdpoly, pol));
+            return TCL_OK;
+
+        case ACCRESET:
+            if (objc != 2) {
+                Tcl_WrongNumArgs(ip, 2, objv, NULL);
+                return TCL_ERROR;
+            }
+            accuReset(acc);
+            return TCL_OK;
+    }
+
+    RETERR("internal error in Tcl_AccuWidgetCmd");
+}
+
+void Tcl_DestroyAccu(ClientData cd) {
+    accuDestroy((accumulator *) cd);
+}
+
+int Tcl_CreateAccuCmd(ClientData cd, Tcl_Interp *ip,
+                      int objc, Tcl_Obj * const objv[]) {
+    accumulator *acc;
+    int modulo = 0;
+
+    if ((objc < 2) || (objc > 3)) {
+        Tcl_WrongNumArgs(ip, 1, objv, "name ?modulo?");
+        return TCL_ERROR;
+    }
+
+    if (objc > 2)
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[2], &modulo))
+            return TCL_ERROR;
+
+    if (modulo < 0) RETERR("modulo must not be negative");
+
+    if (NULL == (acc = accuCreate(modulo))) RETERR("out of memory");
+
+    Tcl_CreateObjCommand(ip, Tcl_GetString(objv[1]),
+                         Tcl_AccuWidgetCmd, (ClientData) acc, Tcl_DestroyAccu);
+
+    Tcl_SetObjResult(ip, objv[1]);
+    return TCL_OK;
+}
+
 int Momap_Init(Tcl_Interp *ip) {
 
     Tcl_InitStubs(ip, "8.0", 0);
@@ -311,6 +598,9 @@ int Momap_Init(Tcl_Interp *ip) {
     Tcl_CreateObjCommand(ip, POLYNSP "monomap",
                          Tcl_CreateMomaCmd, (ClientData) 0, NULL);
 
+    Tcl_CreateObjCommand(ip, POLYNSP "accumulator",
+                         Tcl_CreateAccuCmd, (ClientData) 0, NULL);
+
 
     MomaHashType.version = TCL_HASH_KEY_TYPE_VERSION;
     MomaHashType.flags = 0;
@@ -31,6 +31,30 @@ void   momapDestroy(momap *mo);
 Tcl_Obj *momapGetValPtr(momap *mo, Tcl_Obj *key);
 int momapSetValPtr(momap *mo, Tcl_Obj *key, Tcl_Obj *val);
 
+/* An accumulator collects a sum of polynomials. The coefficient of each
+ * monomial is kept in a hash table, so adding a polynomial does not need
+ * the sort that a poly varappend/varcancel cycle would do; a canonical
+ * (sorted and cancelled) stdpoly is only produced by accuSnapshot. */
+
+typedef struct {
+    exmo *dat;        /* summands; dat[i].coeff is the current coefficient */
+    int   num, nalloc;
+    int  *slots;      /* open addressing table of indices into dat, -1 = free */
+    int   nslots;     /* a power of two */
+    int   modulo;     /* 0 means no reduction */
+} accumulator;
+
+accumulator *accuCreate(int modulo);
+void  accuReset(accumulator *acc);
+void  accuDestroy(accumulator *acc);
+
+/* Adds scale * pol. Without a modulo a coefficient that leaves the int
+ * range gives FAILOVERFLOW; the accumulator is then left unchanged. */
+int   accuAddPoly(accumulator *acc, polyType *tp, void *pol, int scale);
+
+/* returns a new stdpoly with the current sum */
+void *accuSnapshot(accumulator *acc);
+
 int Momap_Init(Tcl_Interp *ip) ;
 
 momap *Tcl_MomapFromObj(Tcl_Interp *ip, Tcl_Obj *obj); 
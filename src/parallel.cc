@@ -0,0 +1,146 @@
+/*
+ * Simple fork/join parallelism on top of Tcl's thread API
+ *
+ * Copyright (C) 2004-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#define PARALLELC
+
+#include <tcl.h>
+#include "parallel.h"
+
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+int thethreads = -1; /* -1 = not yet initialized */
+
+int parallelThreads(void) {
+    if (thethreads < 0) {
+        thethreads = 1;
+#if !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+        {
+            long n = sysconf(_SC_NPROCESSORS_ONLN);
+            if (n > 1) thethreads = (n > 64) ? 64 : (int) n;
+        }
+#endif
+    }
+    return (thethreads < 1) ? 1 : thethreads;
+}
+
+/* The jobs of a parallelRun call form a batch. Batches that still have
+ * jobs to hand out are queued; a persistent pool of worker threads and
+ * the calling threads take jobs from the queue. Since a caller works on
+ * its own batch until all of its jobs are handed out, a job may itself
+ * call parallelRun without deadlocking the pool. */
+
+typedef struct parallelBatch {
+    parallelFunc *func;
+    void *cd;
+    int njobs, next;      /* number of jobs, next job to hand out */
+    int unfinished;       /* jobs that have not yet returned */
+    Tcl_Condition done;   /* signalled when unfinished drops to 0 */
+    struct parallelBatch *link;
+} parallelBatch;
+
+TCL_DECLARE_MUTEX(poolMutex)
+static Tcl_Condition poolWork;        /* signalled when a batch is queued */
+static parallelBatch *poolQueue;      /* batches with jobs left */
+static int poolWorkers;               /* number of worker threads */
+
+/* take the next job of b; the pool mutex must be held */
+static int poolTakeJob(parallelBatch *b) {
+    int job = b->next++;
+    if (b->next == b->njobs) {
+        parallelBatch **bp = &poolQueue;
+        while (*bp != b) bp = &((*bp)->link);
+        *bp = b->link;
+    }
+    return job;
+}
+
+/* run a job of b; the pool mutex must be held and is held again on return */
+static void poolRunJob(parallelBatch *b) {
+    int job = poolTakeJob(b);
+    Tcl_MutexUnlock(&poolMutex);
+    (b->func)(b->cd, job);
+    Tcl_MutexLock(&poolMutex);
+    if (0 == --(b->unfinished))
+        Tcl_ConditionNotify(&(b->done));
+}
+
+static Tcl_ThreadCreateType parallelWorker(ClientData data) {
+    Tcl_MutexLock(&poolMutex);
+    for (;;) {
+        while (NULL == poolQueue)
+            Tcl_ConditionWait(&poolWork, &poolMutex, NULL);
+        poolRunJob(poolQueue);
+    }
+    TCL_THREAD_CREATE_RETURN;
+}
+
+/* make sure the pool has at least num workers; the pool mutex must be
+ * held. The workers live until the process exits. */
+static void poolGrow(int num) {
+    Tcl_ThreadId tid;
+    while (poolWorkers < num) {
+        if (TCL_OK != Tcl_CreateThread(&tid, parallelWorker, NULL,
+                                       TCL_THREAD_STACK_DEFAULT,
+                                       TCL_THREAD_NOFLAGS))
+            break;
+        poolWorkers++;
+    }
+}
+
+void parallelRun(int njobs, parallelFunc *func, void *cd) {
+    parallelBatch b;
+    int k;
+
+    if (njobs < 1) return;
+
+    if (1 == njobs) {
+        func(cd, 0);
+        return;
+    }
+
+    b.func = func;
+    b.cd = cd;
+    b.njobs = njobs;
+    b.next = 0;
+    b.unfinished = njobs;
+    b.done = NULL;
+    b.link = NULL;
+
+    Tcl_MutexLock(&poolMutex);
+
+    k = parallelThreads();
+    poolGrow(((njobs < k) ? njobs : k) - 1);
+
+    if (0 == poolWorkers) {
+        Tcl_MutexUnlock(&poolMutex);
+        for (k=0;k<njobs;k++) func(cd, k);
+        return;
+    }
+
+    /* queue at the end, so that earlier batches are served first */
+    {
+        parallelBatch **bp = &poolQueue;
+        while (NULL != *bp) bp = &((*bp)->link);
+        *bp = &b;
+    }
+    Tcl_ConditionNotify(&poolWork);
+
+    while (b.next < b.njobs)
+        poolRunJob(&b);
+
+    while (b.unfinished)
+        Tcl_ConditionWait(&(b.done), &poolMutex, NULL);
+
+    Tcl_MutexUnlock(&poolMutex);
+    Tcl_ConditionFinalize(&(b.done));
+}
@@ -0,0 +1,36 @@
+/*
+ * Simple fork/join parallelism on top of Tcl's thread API
+ *
+ * Copyright (C) 2004-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#ifndef PARALLEL_DEF
+#define PARALLEL_DEF
+
+#include "common.h"
+
+#ifndef PARALLELC
+extern int thethreads; /* maximal number of threads used by a computation */
+#endif
+
+/* A parallelFunc carries out job number "job" of a parallel computation.
+ * Different jobs are run concurrently, so they must not write to the
+ * same memory. */
+typedef void (parallelFunc)(void *cd, int job);
+
+/* number of worker threads that a computation should use (at least 1) */
+int parallelThreads(void);
+
+/* Run jobs 0,...,njobs-1 concurrently and wait for all of them. The
+ * jobs are shared between the calling thread and a pool of worker
+ * threads that is started on first use and then kept; jobs may call
+ * parallelRun themselves. If no worker can be created the caller runs
+ * all jobs. */
+void parallelRun(int njobs, parallelFunc *func, void *cd);
+
+#endif
@@ -13,8 +13,10 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include "poly.h"
 #include "common.h"
+#include "parallel.h"
 
 #define LOGSTD(msg) if (0) printf("stdpoly::%s\n", msg)
 
@@ -336,6 +338,128 @@ int PLcollectCoeffs(polyType *type, void *self, const exmo *ex,
     return SUCCESS;
 }
 
+/**** arena allocation ************************************************************/
+
+#define ARENACLASSES  31  /* size classes: blocks of 2^k summands, k < ARENACLASSES */
+#define ARENAMAXBLOCK (1 << (ARENACLASSES-1))
+#define MINBLOCK      8   /* initial allocation for a growing polynomial */
+
+typedef struct arenaNode {
+    struct arenaNode *next;
+} arenaNode;
+
+struct polyArena {
+    arenaNode *blocks[ARENACLASSES]; /* free summand blocks, by size class */
+    arenaNode *headers;              /* free stp headers */
+};
+
+static thread_local polyArena *curArena = NULL;
+
+/* smallest k with 2^k >= n */
+static int arenaClassUp(int n) {
+    int k = 0;
+    while ((1 << k) < n) k++;
+    return k;
+}
+
+/* largest k with 2^k <= n */
+static int arenaClassDown(int n) {
+    int k = 0;
+    while ((k < ARENACLASSES-1) && ((2 << k) <= n)) k++;
+    return k;
+}
+
+polyArena *arenaCreate(void) {
+    return (polyArena *) callox(1, sizeof(polyArena));
+}
+
+static void arenaFreeList(arenaNode *nd) {
+    while (NULL != nd) {
+        arenaNode *nxt = nd->next;
+        freex(nd);
+        nd = nxt;
+    }
+}
+
+void arenaRelease(polyArena *ar) {
+    int k;
+    if (NULL == ar) return;
+    if (curArena == ar) curArena = NULL;
+    for (k=0;k<ARENACLASSES;k++)
+        arenaFreeList(ar->blocks[k]);
+    arenaFreeList(ar->headers);
+    freex(ar);
+}
+
+polyArena *arenaEnter(polyArena *ar) {
+    polyArena *prev = curArena;
+    curArena = ar;
+    return prev;
+}
+
+void arenaLeave(polyArena *prev) {
+    curArena = prev;
+}
+
+/* Get a block for at least *n summands; *n is set to the capacity
+ * of the block that is returned. */
+static exmo *arenaAllocBlock(int *n) {
+    polyArena *ar = curArena;
+    if ((NULL != ar) && (*n <= ARENAMAXBLOCK)) {
+        int k = arenaClassUp(*n);
+        arenaNode *nd = ar->blocks[k];
+        *n = 1 << k;
+        if (NULL != nd) {
+            ar->blocks[k] = nd->next;
+            return (exmo *) nd;
+        }
+    }
+    return (exmo *) mallox(sizeof(exmo) * (*n));
+}
+
+static void arenaFreeBlock(exmo *blk, int n) {
+    polyArena *ar = curArena;
+    if (NULL == blk) return;
+    if ((NULL != ar) && (n > 0)) {
+        int k = arenaClassDown(n);
+        arenaNode *nd = (arenaNode *) blk;
+        nd->next = ar->blocks[k];
+        ar->blocks[k] = nd;
+        return;
+    }
+    freex(blk);
+}
+
+exmo *arenaAllocExmo(void) {
+    int n = 1;
+    return arenaAllocBlock(&n);
+}
+
+void arenaFreeExmo(exmo *ex) {
+    arenaFreeBlock(ex, 1);
+}
+
+static stp *arenaAllocHeader(void) {
+    polyArena *ar = curArena;
+    if ((NULL != ar) && (NULL != ar->headers)) {
+        arenaNode *nd = ar->headers;
+        ar->headers = nd->next;
+        return (stp *) nd;
+    }
+    return (stp *) mallox(sizeof(stp));
+}
+
+static void arenaFreeHeader(stp *s) {
+    polyArena *ar = curArena;
+    if (NULL != ar) {
+        arenaNode *nd = (arenaNode *) s;
+        nd->next = ar->headers;
+        ar->headers = nd;
+        return;
+    }
+    freex(s);
+}
+
 /**** standard polynomial type ****************************************************/
 
 int stdGetInfo(void *src, polyInfo *pli) {
@@ -349,15 +473,15 @@ int stdGetInfo(void *src, polyInfo *pli) {
 void *stdCreateCopy(void *src) {
     stp *s = (stp *) src, *n;
     LOGSTD("CreateCopy");
-    if (NULL == (n = (stp *) mallox(sizeof(stp)))) return NULL;
+    if (NULL == (n = arenaAllocHeader())) return NULL;
     if (NULL == s) {
         n->num = n->nalloc = 0; n->dat = NULL;
         return n;
     }
-    n->nalloc = n->num = s->num;
-    if (0 == n->nalloc) n->nalloc = 1;
-    if (NULL == (n->dat = (exmo *) mallox(sizeof(exmo) * n->nalloc))) {
-        freex(n); return NULL;
+    n->num = s->num;
+    n->nalloc = (0 == s->num) ? 1 : s->num;
+    if (NULL == (n->dat = arenaAllocBlock(&(n->nalloc)))) {
+        arenaFreeHeader(n); return NULL;
     }
     if(s->dat) memcpy(n->dat,s->dat,sizeof(exmo) * s->num);
     return n;
@@ -367,9 +491,9 @@ void stdFree(void *self) {
     stp *s = (stp *) self;
     LOGSTD("Free");
     /* printf("nalloc = 0x%x, num = 0x%x, dat = %p\n",s->nalloc,s->num,s->dat); */
-    if (NULL != s->dat) freex(s->dat);
+    arenaFreeBlock(s->dat, s->nalloc);
     s->nalloc = s->num = 0; s->dat = NULL;
-    freex(s);
+    arenaFreeHeader(s);
 }
 
 void stdSwallow(void *self, void *other) {
@@ -377,7 +501,7 @@ void stdSwallow(void *self, void *other) {
     stp *o = (stp *) other;
     LOGSTD("Swallow");
     if (s == o) return;
-    stdFree(self);
+    arenaFreeBlock(s->dat, s->nalloc);
     memcpy(s,o,sizeof(stp));
     o->num = o->nalloc = 0; o->dat = NULL;
 }
@@ -394,7 +518,14 @@ int stdRealloc(void *self, int nalloc) {
     LOGSTD("Realloc");
     if (nalloc < s->num) nalloc = s->num;
     if (0 == nalloc) nalloc = 1;
-    if (NULL == (ndat = (exmo*)reallox(s->dat,sizeof(exmo) * nalloc)))
+    if (NULL != curArena) {
+        if (NULL == (ndat = arenaAllocBlock(&nalloc)))
+            return FAILMEM;
+        if (NULL != s->dat) {
+            memcpy(ndat, s->dat, sizeof(exmo) * s->num);
+            arenaFreeBlock(s->dat, s->nalloc);
+        }
+    } else if (NULL == (ndat = (exmo*)reallox(s->dat,sizeof(exmo) * nalloc)))
         return FAILMEM;
     s->dat = ndat; s->nalloc = nalloc;
     return SUCCESS;
@@ -406,30 +537,154 @@ void stdSort(void *self) {
     if(s->dat) qsort(s->dat,s->num,sizeof(exmo),compareExmo);
 }
 
-void stdCancel(void *self, int mod) {
-    stp *s = (stp *) self;
-    int i,j,k; double d;
-    LOGSTD("Cancel");
-    stdSort(self);
-    for (k=i=0,j=0;i<s->num;)
-        if (((j+1)<s->num) && (0==compareExmo(&(s->dat[i]),&(s->dat[j+1])))) {
-            s->dat[i].coeff += s->dat[j+1].coeff;
-            if (mod) s->dat[i].coeff %= mod;
+/* Merge equal summands of the sorted array dat[0..num-1] and remove
+ * those whose coefficient vanishes; returns the new number of summands. */
+static int stdCancelSorted(exmo *dat, int num, int mod) {
+    int i,j,k;
+    for (k=i=0,j=0;i<num;)
+        if (((j+1)<num) && (0==compareExmo(&(dat[i]),&(dat[j+1])))) {
+            dat[i].coeff += dat[j+1].coeff;
+            if (mod) dat[i].coeff %= mod;
             j++;
         } else {
-            int oval = s->dat[i].coeff;
-            if (mod) s->dat[i].coeff %= mod;
-            if (0!=s->dat[i].coeff) {
-                if ((k!=i) || (oval != s->dat[i].coeff))
-                    copyExmo(&(s->dat[k]),&(s->dat[i]));
+            int oval = dat[i].coeff;
+            if (mod) dat[i].coeff %= mod;
+            if (0!=dat[i].coeff) {
+                if ((k!=i) || (oval != dat[i].coeff))
+                    copyExmo(&(dat[k]),&(dat[i]));
                 k++;
             }
             i=j+1; j=i;
         }
+    return k;
+}
+
+/* Polynomials with at least PARCANCELMIN summands are cancelled in
+ * parallel by a sample sort: the summands are distributed into one
+ * bucket per thread according to splitters taken from a sorted sample,
+ * so that equal summands land in the same bucket and the buckets are
+ * already in canonical order. Each thread then sorts and cancels its
+ * own bucket. */
+
+#define PARCANCELMIN  (1 << 16)
+#define PARSAMPLES    64         /* samples per bucket */
+
+typedef struct {
+    exmo *dat, *tmp;
+    int num, mod, nbuck;
+    exmo *split;                 /* nbuck-1 splitters */
+    int *cnt;                    /* cnt[chunk*nbuck+bucket] */
+    int *off;                    /* same layout, start in tmp */
+    int *bstart, *bnum;          /* bucket range in tmp / result length */
+} parCancelInfo;
+
+static int parBucket(parCancelInfo *pc, const exmo *e) {
+    int lo = 0, hi = pc->nbuck - 1;
+    /* find first splitter that is bigger than *e */
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (compareExmo(e, &(pc->split[mid])) < 0) hi = mid; else lo = mid + 1;
+    }
+    return lo;
+}
+
+#define CHUNKSTART(pc,c) ((int) (((long long) (pc)->num * (c)) / (pc)->nbuck))
+
+static void parCancelCount(void *cd, int c) {
+    parCancelInfo *pc = (parCancelInfo *) cd;
+    int i, *cnt = pc->cnt + c * pc->nbuck;
+    for (i=CHUNKSTART(pc,c);i<CHUNKSTART(pc,c+1);i++)
+        cnt[parBucket(pc, &(pc->dat[i]))]++;
+}
+
+static void parCancelScatter(void *cd, int c) {
+    parCancelInfo *pc = (parCancelInfo *) cd;
+    int i, *off = pc->off + c * pc->nbuck;
+    for (i=CHUNKSTART(pc,c);i<CHUNKSTART(pc,c+1);i++)
+        copyExmo(&(pc->tmp[off[parBucket(pc, &(pc->dat[i]))]++]), &(pc->dat[i]));
+}
+
+static void parCancelBucket(void *cd, int b) {
+    parCancelInfo *pc = (parCancelInfo *) cd;
+    exmo *bd = pc->tmp + pc->bstart[b];
+    qsort(bd, pc->bnum[b], sizeof(exmo), compareExmo);
+    pc->bnum[b] = stdCancelSorted(bd, pc->bnum[b], pc->mod);
+}
+
+/* returns the new number of summands, or -1 if not enough memory */
+static int stdParallelCancel(stp *s, int mod, int nthr) {
+    parCancelInfo pc;
+    exmo *sample;
+    int i, b, c, k, nsmp = nthr * PARSAMPLES;
+
+    pc.dat = s->dat; pc.num = s->num; pc.mod = mod; pc.nbuck = nthr;
+
+    pc.tmp   = (exmo *) mallox(sizeof(exmo) * s->num);
+    sample   = (exmo *) mallox(sizeof(exmo) * nsmp);
+    pc.cnt   = (int *) callox(2 * nthr * nthr + 2 * nthr, sizeof(int));
+
+    if ((NULL == pc.tmp) || (NULL == sample) || (NULL == pc.cnt)) {
+        if (NULL != pc.tmp) freex(pc.tmp);
+        if (NULL != sample) freex(sample);
+        if (NULL != pc.cnt) freex(pc.cnt);
+        return -1;
+    }
+
+    pc.off    = pc.cnt + nthr * nthr;
+    pc.bstart = pc.off + nthr * nthr;
+    pc.bnum   = pc.bstart + nthr;
+
+    /* choose splitters from an evenly spaced sample */
+    for (i=0;i<nsmp;i++)
+        copyExmo(&(sample[i]), &(s->dat[(int) (((long long) s->num * i) / nsmp)]));
+    qsort(sample, nsmp, sizeof(exmo), compareExmo);
+    for (b=1;b<nthr;b++)
+        copyExmo(&(sample[b-1]), &(sample[b * PARSAMPLES]));
+    pc.split = sample;
+
+    parallelRun(nthr, parCancelCount, &pc);
+
+    /* bucket b of chunk c starts after all of bucket b's earlier chunks */
+    for (k=b=0;b<nthr;b++) {
+        pc.bstart[b] = k;
+        for (c=0;c<nthr;c++) {
+            pc.off[c*nthr+b] = k;
+            k += pc.cnt[c*nthr+b];
+        }
+        pc.bnum[b] = k - pc.bstart[b];
+    }
+
+    parallelRun(nthr, parCancelScatter, &pc);
+    parallelRun(nthr, parCancelBucket, &pc);
+
+    for (k=b=0;b<nthr;b++) {
+        memcpy(&(s->dat[k]), &(pc.tmp[pc.bstart[b]]), sizeof(exmo) * pc.bnum[b]);
+        k += pc.bnum[b];
+    }
+
+    freex(pc.tmp);
+    freex(sample);
+    freex(pc.cnt);
+
+    return k;
+}
+
+void stdCancel(void *self, int mod) {
+    stp *s = (stp *) self;
+    int nthr, k = -1; double d;
+    LOGSTD("Cancel");
+    if ((s->num >= PARCANCELMIN) && (1 < (nthr = parallelThreads())))
+        k = stdParallelCancel(s, mod, nthr);
+    if (k < 0) {
+        stdSort(self);
+        k = stdCancelSorted(s->dat, s->num, mod);
+    }
     s->num = k;
-    if (s->nalloc) {
+    /* only give memory back if most of the block is unused; otherwise
+     * a subsequent append would immediately have to grow it again */
+    if (s->nalloc > MINBLOCK) {
         d = s->num; d /= s->nalloc;
-        if (0.8 > d) stdRealloc(self, s->num * 1.1);
+        if (0.5 > d) stdRealloc(self, s->num + (s->num >> 3));
     }
 }
 
@@ -530,8 +785,12 @@ int stdAppendExmo(void *self, const exmo *ex) {
     stp *s = (stp *) self;
     LOGSTD("AppendExmo");
     if (s->num == s->nalloc) {
-        int aux = s->nalloc + 10;
-        if (SUCCESS != stdRealloc(self, s->nalloc + ((aux > 200) ? 200: aux)))
+        /* grow geometrically, so that n appends cost O(n) copying */
+        int aux;
+        if (s->nalloc > INT_MAX / 3 * 2) return FAILMEM;
+        aux = s->nalloc + (s->nalloc >> 1);
+        if (aux < MINBLOCK) aux = MINBLOCK;
+        if (SUCCESS != stdRealloc(self, aux))
             return FAILMEM;
     }
     copyExmo(&(s->dat[s->num++]),ex);
@@ -601,6 +860,247 @@ struct polyType stdPolyType = {
     .shift      = &stdShift
 };
 
+/**** slices of a shared stdpoly *******************************************************/
+
+polyShare *shareCreate(stp *pol) {
+    polyShare *sh = (polyShare *) mallox(sizeof(polyShare));
+    if (NULL == sh) return NULL;
+    sh->refcnt = 0;
+    sh->pol = pol;
+    return sh;
+}
+
+void shareRelease(polyShare *sh) {
+    if (NULL == sh) return;
+    if (--(sh->refcnt) > 0) return;
+    stdFree(sh->pol);
+    freex(sh);
+}
+
+slice *sliceCreate(polyShare *sh, int start, int num) {
+    slice *v = (slice *) mallox(sizeof(slice));
+    if (NULL == v) return NULL;
+    v->share = sh;
+    v->start = start;
+    v->num = num;
+    if (NULL != sh) sh->refcnt++;
+    return v;
+}
+
+#define SLICEDAT(v) ((v)->share->pol->dat + (v)->start)
+
+int sliceGetInfo(void *src, polyInfo *pli) {
+    slice *v = (slice *) src;
+    pli->name = "slice";
+    pli->bytesAllocated = sizeof(slice);
+    pli->bytesUsed      = sizeof(slice) + (v->num * sizeof(exmo));
+    return SUCCESS;
+}
+
+void *sliceCreateCopy(void *src) {
+    slice *v = (slice *) src;
+    if (NULL == v) return sliceCreate(NULL, 0, 0);
+    return sliceCreate(v->share, v->start, v->num);
+}
+
+void sliceFree(void *self) {
+    slice *v = (slice *) self;
+    shareRelease(v->share);
+    freex(v);
+}
+
+int sliceGetLength(void *self) {
+    return ((slice *) self)->num;
+}
+
+int sliceGetExmoPtr(void *self, exmo **ptr, int idx) {
+    slice *v = (slice *) self;
+    if ((idx < 0) || (idx >= v->num)) return FAIL;
+    *ptr = SLICEDAT(v) + idx;
+    return SUCCESS;
+}
+
+int sliceCollectCoeffs(void *self, const exmo *e, int *coeff, int mod, int flags) {
+    slice *v = (slice *) self;
+    const exmo *w;
+    int i;
+    *coeff = 0;
+    for (i=0, w=SLICEDAT(v); i<v->num; i++, w++)
+        if (0 == compareExmo(w,e)) {
+            *coeff += w->coeff;
+            if (mod) *coeff %= mod;
+        }
+    return SUCCESS;
+}
+
+struct polyType slicePolyType = {
+    .getInfo    = &sliceGetInfo,
+    .createCopy = &sliceCreateCopy,
+    .free       = &sliceFree,
+    .getNumsum  = &sliceGetLength,
+    .getExmoPtr = &sliceGetExmoPtr,
+    .collectCoeffs = &sliceCollectCoeffs
+};
+
+int PLgetSummandArray(polyType *type, void *poly, exmo **dat, int *num) {
+    if (stdpoly == type) {
+        stp *s = (stp *) poly;
+        *dat = s->dat; *num = s->num;
+        return SUCCESS;
+    }
+    if (slicepoly == type) {
+        slice *v = (slice *) poly;
+        *dat = (0 == v->num) ? NULL : SLICEDAT(v);
+        *num = v->num;
+        return SUCCESS;
+    }
+    return FAILIMPOSSIBLE;
+}
+
+/**** binary format ******************************************************************/
+
+int binEncodeInts(unsigned char *buf, const long long *vals, int num) {
+    unsigned char *p = buf;
+    int i;
+    for (i=0;i<num;i++) {
+        long long v = vals[i];
+        int next;
+        while (1) {
+            next = (int) (v & 0x7f);
+            v >>= 7;
+            if ((0 == v) || (-1 == v)) break;
+            *p++ = next | 0x80;
+        }
+        if ((v >= 0) && (0x40 & next)) {
+            /* need an extra zero to mark this value as positive */
+            *p++ = next | 0x80;
+            *p++ = 0;
+        } else if ((v < 0) && (0 == (0x40 & next))) {
+            /* need an extra -1 to mark this value as negative */
+            *p++ = next | 0x80;
+            *p++ = 0x7f;
+        } else {
+            *p++ = next;
+        }
+    }
+    return p - buf;
+}
+
+int binDecodeInt(const unsigned char **data, const unsigned char *end,
+                 long long *val) {
+    const unsigned char *p = *data;
+    unsigned long long res = 0;
+    int off = 0, x;
+    do {
+        if (p >= end) return FAILUNTRUE;
+        if (off > 63) return FAIL;
+        x = *p++;
+        res |= ((unsigned long long) (x & 0x7f)) << off;
+        off += 7;
+    } while (x & 0x80);
+    if ((0x40 & x) && (off < 64))
+        res |= ~0ULL << off; /* value is negative */
+    *val = (long long) res;
+    *data = p;
+    return SUCCESS;
+}
+
+int binEncodePoly(polyType *tp, void *pol, unsigned char **res, int *len) {
+    long long vals[NALG+4];
+    unsigned char *buf;
+    int i, j, num = PLgetNumsum(tp, pol), rlen;
+    size_t nalloc, pos = 0;
+    exmo ex;
+
+    /* a summand needs at most 10 bytes per integer; most need only a
+     * few, so we start small and grow on demand */
+    nalloc = 10 * (NALG+4) * (size_t) ((num < 16) ? 16 : ((num < 1024) ? num : 1024 + num / 2));
+    if (NULL == (buf = (unsigned char *) mallox(nalloc)))
+        return FAILMEM;
+
+    for (i=0;i<num;i++) {
+        if (pos + 10 * (NALG+4) > nalloc) {
+            unsigned char *aux;
+            nalloc += nalloc / 2;
+            /* the result length must fit into an int */
+            if ((nalloc > INT_MAX)
+                || (NULL == (aux = (unsigned char *) reallox(buf, nalloc)))) {
+                freex(buf);
+                return FAILMEM;
+            }
+            buf = aux;
+        }
+        if (SUCCESS != PLgetExmo(tp, pol, &ex, i)) {
+            freex(buf);
+            return FAIL;
+        }
+        rlen = exmoGetRedLen(&ex);
+        vals[0] = ex.coeff;
+        vals[1] = ex.gen;
+        vals[2] = ex.ext;
+        vals[3] = rlen;
+        for (j=0;j<rlen;j++) vals[4+j] = ex.r.dat[j];
+        pos += binEncodeInts(buf + pos, vals, 4 + rlen);
+    }
+
+    *res = buf;
+    *len = (int) pos;
+    return SUCCESS;
+}
+
+/* does v fit into the (signed integer) exmo field fld? */
+#define EXMOFIELDFITS(fld, v)                               \
+    (((v) >= -(1LL << (8 * sizeof(fld) - 1)))               \
+     && ((v) < (1LL << (8 * sizeof(fld) - 1))))
+
+int binDecodePoly(polyType *tp, void *pol, const unsigned char *data, int len,
+                  int scale, int modulo, int *used) {
+    const unsigned char *p = data, *end = data + len;
+    long long c, g, e, cnt, r;
+    int j, rcode = SUCCESS;
+    exmo ex;
+
+    if (modulo) scale %= modulo;
+
+    *used = 0;
+    while (p < end) {
+        if ((SUCCESS != (rcode = binDecodeInt(&p, end, &c)))
+            || (SUCCESS != (rcode = binDecodeInt(&p, end, &g)))
+            || (SUCCESS != (rcode = binDecodeInt(&p, end, &e)))
+            || (SUCCESS != (rcode = binDecodeInt(&p, end, &cnt))))
+            break;
+        if ((cnt < 0) || (cnt > NALG)
+            || !EXMOFIELDFITS(ex.gen, g) || !EXMOFIELDFITS(ex.ext, e))
+            return FAIL;
+        r = e;
+        for (j=0;j<cnt;j++) {
+            if (SUCCESS != (rcode = binDecodeInt(&p, end, &r)))
+                break;
+            if (!EXMOFIELDFITS(ex.r.dat[j], r))
+                return FAIL;
+            ex.r.dat[j] = r;
+        }
+        if (SUCCESS != rcode) break;
+        /* pad as in the list representation */
+        for (r = (r < 0) ? -1 : 0; j<NALG; j++) ex.r.dat[j] = r;
+        /* c is reduced or fits an int, so c * scale cannot overflow */
+        if (modulo) c %= modulo;
+        else if (!EXMOFIELDFITS(ex.coeff, c)) return FAILOVERFLOW;
+        c *= scale;
+        if (modulo) c %= modulo;
+        if (!EXMOFIELDFITS(ex.coeff, c)) return FAILOVERFLOW;
+        ex.coeff = c;
+        ex.gen   = g;
+        ex.ext   = e;
+        if (SUCCESS != (rcode = PLappendExmo(tp, pol, &ex)))
+            return rcode;
+        *used = p - data;
+    }
+
+    /* running out of data in the middle of a summand is not an error */
+    return (FAILUNTRUE == rcode) ? SUCCESS : rcode;
+}
+
 void *PLcreateStdCopy(polyType *type, void *poly) {
     return PLcreateCopy(stdpoly,type,poly);
 }
@@ -610,6 +1110,12 @@ void *PLcreateCopy(polyType *newtype, polyType *type, void *poly) {
     LOGPLFMT(PLcreateCopy, "orig at %p",poly);
     if (newtype == type)
         return (newtype->createCopy)(poly);
+    if ((stdpoly == newtype) && (slicepoly == type)) {
+        stp aux;
+        PLgetSummandArray(type, poly, &(aux.dat), &(aux.num));
+        aux.nalloc = aux.num;
+        return stdCreateCopy(&aux);
+    }
     if (NULL == (res = (stp*)(newtype->createCopy)(NULL)))
         return NULL;
     if (SUCCESS != PLappendPoly(newtype,res,type,poly,NULL,0,1,0)) {
@@ -721,6 +1227,7 @@ int PLsteenrodMultiply(polyType **rtp, void **res,
                        polyType *sftp, void *sf,
                        primeInfo *pi, const exmo *pro) {
     int flen, slen;
+    polyArena *ar, *prev;
     int fpos = (SUCCESS == PLtest(fftp,ff,ISPOSITIVE));
     int fneg = (SUCCESS == PLtest(fftp,ff,ISNEGATIVE));
     int spos = (SUCCESS == PLtest(sftp,sf,ISPOSITIVE));
@@ -741,12 +1248,25 @@ int PLsteenrodMultiply(polyType **rtp, void **res,
     /* negative times negative is undefined */
     if (fneg && sneg) return FAILIMPOSSIBLE;
 
+    /* the product can be much bigger than its factors: let it grow
+     * and shrink inside a private arena */
+    ar = arenaCreate();
+    prev = arenaEnter(ar);
+
     *rtp = stdpoly;
     *res = PLcreate(*rtp);
     stdAddProductToPoly(*rtp, *res, fftp, ff, sftp, sf, pi, pro, fpos, spos);
 
     PLcancel(*rtp, *res, pi->prime);
 
+    arenaLeave(prev);
+    arenaRelease(ar);
+
+    /* arena blocks are rounded up to a power of two; give the slack
+     * back before the product is handed out */
+    if (((stp *) *res)->nalloc > ((stp *) *res)->num)
+        stdRealloc(*res, ((stp *) *res)->num);
+
     return SUCCESS;
 }
 
@@ -265,6 +265,90 @@ extern polyType stdPolyType;
 
 int stdRealloc(void *self, int nalloc);
 
+/* A polyArena recycles the storage of stdpoly headers, summand blocks
+ * and single monomials. While an arena is active, storage that is freed
+ * is kept on per-size-class free lists and handed out again by the next
+ * allocation; summand blocks grow geometrically through these size classes.
+ * Everything is ordinary heap memory, so objects can safely outlive the
+ * arena. arenaRelease returns all cached storage to the system at once. */
+
+typedef struct polyArena polyArena;
+
+polyArena *arenaCreate(void);
+void       arenaRelease(polyArena *ar);
+
+/* make "ar" the active arena of the calling thread; returns the
+ * previously active one, which should later be passed to arenaLeave */
+polyArena *arenaEnter(polyArena *ar);
+void       arenaLeave(polyArena *prev);
+
+/* storage for a single monomial, as used by the Tcl exmo objects */
+exmo *arenaAllocExmo(void);
+void  arenaFreeExmo(exmo *ex);
+
+/* A slice is a read-only view of a contiguous range of summands of a
+ * stdpoly. The summands live in a reference counted polyShare which is
+ * released when the last slice that uses it is freed. Slices implement
+ * only the read-only methods; callers that need to modify one have to
+ * convert it to a stdpoly first. */
+
+typedef struct {
+    int refcnt;
+    stp *pol;
+} polyShare;
+
+typedef struct {
+    polyShare *share;
+    int start, num;
+} slice;
+
+#ifndef POLYC
+extern polyType slicePolyType;
+#endif
+
+#define slicepoly (&(slicePolyType))
+
+polyShare *shareCreate(stp *pol);  /* takes ownership of pol */
+void       shareRelease(polyShare *sh);
+
+/* create a slice of summands start,...,start+num-1 of sh; the
+ * refcount of sh is incremented */
+slice *sliceCreate(polyShare *sh, int start, int num);
+
+/* for stdpolys and slices: get a pointer to the contiguous array of summands */
+int PLgetSummandArray(polyType *type, void *poly, exmo **dat, int *num);
+
+/* The "bin" format for polynomials, as used in our databases: each summand
+ * is written as the integer sequence
+ *
+ *    coeff gen ext len r_1 ... r_len       (len = reduced length)
+ *
+ * and every integer is stored as a sequence of 7-bit groups, least
+ * significant group first, with 0x80 as continuation marker and 0x40 of
+ * the last byte as sign bit. */
+
+/* encode a list of integers; *buf must have room for 10 bytes per entry.
+ * returns the number of bytes written. */
+int binEncodeInts(unsigned char *buf, const long long *vals, int num);
+
+/* decode the next integer from *data; returns FAILUNTRUE if the input ends
+ * early and FAIL if the value does not fit into 64 bits */
+int binDecodeInt(const unsigned char **data, const unsigned char *end,
+                 long long *val);
+
+/* Encode a polynomial; *res is allocated with mallox and must be freed
+ * by the caller. */
+int binEncodePoly(polyType *tp, void *pol, unsigned char **res, int *len);
+
+/* Decode summands and append them (multiplied by scale) to pol. This
+ * can be used to decode a stream chunk by chunk: *used is set to the
+ * number of bytes that form complete summands, and an incomplete summand
+ * at the end is not an error. FAIL is returned for malformed input,
+ * including values that do not fit into an exmo, and FAILOVERFLOW if a
+ * scaled coefficient does not fit. */
+int binDecodePoly(polyType *tp, void *pol, const unsigned char *data, int len,
+                  int scale, int modulo, int *used);
+
 /* create a stdpoly copy of a polynomial */
 void *PLcreateStdCopy(polyType *type, void *poly);
 
@@ -0,0 +1,1235 @@
+/*
+ * Sparse matrices and structured Gaussian elimination
+ *
+ * Copyright (C) 2005-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "sparse.h"
+#include "linalg.h"
+
+/* The matrices that ComputeMatrix produces have only a handful of entries
+ * per row. The sparsematrix keeps just these entries, and eliminates
+ * with pivots chosen by the Markowitz criterion: the pivot (r,c) should
+ * minimize (#entries in row r - 1) * (#entries in column c - 1), which
+ * bounds the fill-in that it can cause. Only SPSEARCH rows and columns
+ * of lowest count are examined for every pivot.
+ *
+ * As the remaining rows fill in, sparse elimination gets more expensive
+ * than dense elimination; once the density of the active part exceeds
+ * 1/SPFILL (1/SPFILL2 at the prime 2) the rest of the work is handed to
+ * the stdmatrix, resp. stdmatrix2, code. */
+
+#ifndef SPSEARCH
+#  define SPSEARCH 4
+#endif
+#ifndef SPFILL
+#  define SPFILL   16
+#endif
+#ifndef SPFILL2
+#  define SPFILL2  64
+#endif
+
+/* The pivots are not the first nonzero entries of their rows, so the
+ * result of the orthonormalization is not in echelon form. It still has
+ * the property that the lift and quotient code relies on: in the order
+ * of the rows, every row has a nonzero entry in a column where all later
+ * rows vanish. spPivots recovers such columns. */
+
+#define  PROGVARINIT     \
+    double perc = 0;     \
+    if (NULL != progvar) Tcl_LinkVar(ip, progvar, (char *) &perc, TCL_LINK_DOUBLE);
+
+#define PROGVARSET(val)  \
+    if (NULL != progvar) Tcl_UpdateLinkedVar(ip, progvar); \
+    if (LINALG_INTERRUPT_VARIABLE) goto done;
+
+#define PROGVARDONE \
+    if (NULL != progvar) Tcl_UnlinkVar(ip, progvar);
+
+#define LINALG_INTERRUPT_VARIABLE (*interruptVar)
+
+static int zero;
+
+#define PROGINFO(prg)                                                   \
+    Tcl_Interp *ip = NULL;                                              \
+    const char *progvar = NULL;                                         \
+    int pmsk = 0, *interruptVar = &zero;                                \
+    if (NULL != prg) {                                                  \
+        ip = prg->ip; progvar = prg->progvar; pmsk = prg->pmsk;         \
+        if (NULL != prg->interruptVar) interruptVar = prg->interruptVar; \
+    }
+
+/**** ROWS ******************************************************************/
+
+static int spmod(int v, int prime) {
+    v %= prime;
+    return (v < 0) ? v + prime : v;
+}
+
+static int spGrowRow(sprow *r, int num) {
+    if (num > r->alloc) {
+        int nal = MAX(num, r->alloc + r->alloc / 2 + 4);
+        spentry *aux = (spentry *) reallox(r->ent, nal * sizeof(spentry));
+        if (NULL == aux) return FAILMEM;
+        r->ent = aux;
+        r->alloc = nal;
+    }
+    return SUCCESS;
+}
+
+static void spFreeRow(sprow *r) {
+    if (NULL != r->ent) freex(r->ent);
+    r->ent = NULL;
+    r->num = r->alloc = 0;
+}
+
+static int spCopyRow(sprow *dst, const sprow *src) {
+    if (SUCCESS != spGrowRow(dst, src->num)) return FAILMEM;
+    if (src->num) memcpy(dst->ent, src->ent, src->num * sizeof(spentry));
+    dst->num = src->num;
+    return SUCCESS;
+}
+
+/* index of the first entry of r in a column >= col */
+static int spFind(const sprow *r, int col) {
+    int lo = 0, hi = r->num;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (r->ent[mid].col < col) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static void spReduceRow(sprow *r, int prime) {
+    int i, n = 0;
+    for (i = 0; i < r->num; i++) {
+        int v = spmod(r->ent[i].val, prime);
+        if (v) {
+            r->ent[n].col = r->ent[i].col;
+            r->ent[n++].val = v;
+        }
+    }
+    r->num = n;
+}
+
+/* dst += f * src, reduced mod prime unless prime is zero. The sum is
+ * built in tmp, which then trades places with dst. */
+static int spAxpy(sprow *dst, const sprow *src, int f, int prime, sprow *tmp) {
+    const spentry *d = dst->ent, *de = d + dst->num;
+    const spentry *s = src->ent, *se = s + src->num;
+    spentry *t;
+    sprow aux;
+
+    if (SUCCESS != spGrowRow(tmp, dst->num + src->num)) return FAILMEM;
+    for (t = tmp->ent; (d < de) || (s < se);) {
+        int col, v;
+        if ((s == se) || ((d < de) && (d->col < s->col))) {
+            *t++ = *d++;
+            continue;
+        }
+        if ((d == de) || (s->col < d->col)) {
+            col = s->col; v = f * s->val;
+        } else {
+            col = d->col; v = d->val + f * s->val;
+            d++;
+        }
+        s++;
+        if (prime) v = spmod(v, prime);
+        if (v) {
+            t->col = col; t->val = v; t++;
+        }
+    }
+    tmp->num = t - tmp->ent;
+    aux = *dst; *dst = *tmp; *tmp = aux;
+    return SUCCESS;
+}
+
+/* A dense accumulator for linear combinations of rows of length size. */
+
+typedef struct {
+    int  *val;
+    char *mark;
+    int  *idx, num, size;
+} spacc;
+
+static int spAccInit(spacc *acc, int size) {
+    acc->size = size;
+    acc->num = 0;
+    acc->val = (int *) callox(size + 1, sizeof(int));
+    acc->mark = (char *) callox(size + 1, 1);
+    acc->idx = (int *) mallox((size + 1) * sizeof(int));
+    if ((NULL == acc->val) || (NULL == acc->mark) || (NULL == acc->idx))
+        return FAILMEM;
+    return SUCCESS;
+}
+
+static void spAccFree(spacc *acc) {
+    if (NULL != acc->val) freex(acc->val);
+    if (NULL != acc->mark) freex(acc->mark);
+    if (NULL != acc->idx) freex(acc->idx);
+}
+
+static void spAccSet(spacc *acc, int c, int v) {
+    if (!acc->mark[c]) {
+        acc->mark[c] = 1;
+        acc->idx[acc->num++] = c;
+    }
+    acc->val[c] = v;
+}
+
+/* acc += f * r; entries beyond acc->size are ignored */
+static void spAccAdd(spacc *acc, const sprow *r, int f, int prime) {
+    int k;
+    for (k = 0; k < r->num; k++) {
+        int c = r->ent[k].col;
+        if (c < acc->size)
+            spAccSet(acc, c, spmod(acc->val[c] + f * r->ent[k].val, prime));
+    }
+}
+
+static int cmpint(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+/* res = acc, which is cleared */
+static int spAccFlush(spacc *acc, sprow *res) {
+    int i, n = 0;
+    if (8 * acc->num > acc->size) {
+        for (i = 0; i < acc->size; i++)
+            if (acc->mark[i]) acc->idx[n++] = i;
+    } else {
+        qsort(acc->idx, acc->num, sizeof(int), cmpint);
+    }
+    n = acc->num;
+    acc->num = 0;
+    if (SUCCESS != spGrowRow(res, n)) return FAILMEM;
+    for (res->num = i = 0; i < n; i++) {
+        int c = acc->idx[i];
+        if (acc->val[c]) {
+            res->ent[res->num].col = c;
+            res->ent[res->num++].val = acc->val[c];
+        }
+        acc->val[c] = 0;
+        acc->mark[c] = 0;
+    }
+    return SUCCESS;
+}
+
+/**** THE MATRIX TYPE *******************************************************/
+
+static spmatrix *spCreate(int rows, int cols) {
+    spmatrix *m = (spmatrix *) mallox(sizeof(spmatrix));
+    if (NULL == m) return NULL;
+    if (NULL == (m->row = (sprow *) callox(rows + 1, sizeof(sprow)))) {
+        freex(m);
+        return NULL;
+    }
+    m->rows = rows;
+    m->cols = cols;
+    return m;
+}
+
+static void spDestroy(spmatrix *m) {
+    int i;
+    for (i = 0; i < m->rows; i++)
+        spFreeRow(m->row + i);
+    freex(m->row);
+    freex(m);
+}
+
+/* a new matrix made of the rows idx[0],...,idx[num-1] of m, which are
+ * taken away from m */
+static spmatrix *spTakeRows(spmatrix *m, const int *idx, int num) {
+    spmatrix *res = spCreate(num, m->cols);
+    int i;
+    if (NULL != res)
+        for (i = 0; i < num; i++) {
+            res->row[i] = m->row[idx[i]];
+            memset(m->row + idx[i], 0, sizeof(sprow));
+        }
+    return res;
+}
+
+/* keep only the rows idx[0],...,idx[num-1] of m, in this order */
+static int spKeepRows(spmatrix *m, const int *idx, int num) {
+    spmatrix *aux = spTakeRows(m, idx, num);
+    sprow *r;
+    if (NULL == aux) return FAILMEM;
+    r = m->row; m->row = aux->row; aux->row = r;
+    aux->rows = m->rows; m->rows = num;
+    spDestroy(aux);
+    return SUCCESS;
+}
+
+int spGetEntry(void *mat, int row, int col, int *val) {
+    spmatrix *m = (spmatrix *) mat;
+    sprow *r;
+    int k;
+    if ((row >= m->rows) || (col >= m->cols))
+        return FAILIMPOSSIBLE;
+    r = m->row + row;
+    k = spFind(r, col);
+    *val = ((k < r->num) && (r->ent[k].col == col)) ? r->ent[k].val : 0;
+    return SUCCESS;
+}
+
+int spSetEntry(void *mat, int row, int col, int val) {
+    spmatrix *m = (spmatrix *) mat;
+    sprow *r;
+    cint tst = val;
+    int k;
+    if ((row >= m->rows) || (col >= m->cols))
+        return FAILIMPOSSIBLE;
+    /* first check if the value fits in a "cint" */
+    if (tst != val)
+        return FAILIMPOSSIBLE;
+    r = m->row + row;
+    k = spFind(r, col);
+    if ((k < r->num) && (r->ent[k].col == col)) {
+        if (val) {
+            r->ent[k].val = val;
+        } else {
+            memmove(r->ent + k, r->ent + k + 1, (r->num - k - 1) * sizeof(spentry));
+            r->num--;
+        }
+        return SUCCESS;
+    }
+    if (0 == val)
+        return SUCCESS;
+    if (SUCCESS != spGrowRow(r, r->num + 1))
+        return FAILMEM;
+    memmove(r->ent + k + 1, r->ent + k, (r->num - k) * sizeof(spentry));
+    r->ent[k].col = col;
+    r->ent[k].val = val;
+    r->num++;
+    return SUCCESS;
+}
+
+int spAddToEntry(void *mat, int row, int col, int val, int mod) {
+    int rcode, aux;
+    if (SUCCESS != (rcode = spGetEntry(mat, row, col, &aux)))
+        return rcode;
+    aux = aux + val;
+    if (mod) aux = spmod(aux, mod);
+    return spSetEntry(mat, row, col, aux);
+}
+
+void spGetDimensions(void *mat, int *row, int *col) {
+    spmatrix *m = (spmatrix *) mat;
+    *row = m->rows; *col = m->cols;
+}
+
+void *spCreateMatrix(int row, int col) {
+    return spCreate(row, col);
+}
+
+void *spCreateCopy(void *mat) {
+    spmatrix *m = (spmatrix *) mat, *res = spCreate(m->rows, m->cols);
+    int i;
+    if (NULL != res)
+        for (i = 0; i < m->rows; i++)
+            if (SUCCESS != spCopyRow(res->row + i, m->row + i)) {
+                spDestroy(res);
+                return NULL;
+            }
+    return res;
+}
+
+void spDestroyMatrix(void *mat) {
+    spDestroy((spmatrix *) mat);
+}
+
+void spClearMatrix(void *mat) {
+    spmatrix *m = (spmatrix *) mat;
+    int i;
+    for (i = 0; i < m->rows; i++)
+        m->row[i].num = 0;
+}
+
+void spUnitMatrix(void *mat) {
+    spmatrix *m = (spmatrix *) mat;
+    int i;
+    spClearMatrix(mat);
+    for (i = MIN(m->rows, m->cols); i--;)
+        spSetEntry(mat, i, i, 1);
+}
+
+int spReduceMatrix(void *mat, int prime) {
+    spmatrix *m = (spmatrix *) mat;
+    int i;
+    for (i = 0; i < m->rows; i++)
+        spReduceRow(m->row + i, prime);
+    return SUCCESS;
+}
+
+int spIsZero(void *mat) {
+    spmatrix *m = (spmatrix *) mat;
+    int i;
+    for (i = 0; i < m->rows; i++)
+        if (m->row[i].num) return 0;
+    return 1;
+}
+
+void *spShrinkRows(void *mat, int *idx, int num) {
+    spmatrix *m = (spmatrix *) mat, *res = spCreate(num, m->cols);
+    int i;
+    if (NULL != res)
+        for (i = 0; i < num; i++)
+            if (SUCCESS != spCopyRow(res->row + i, m->row + idx[i])) {
+                spDestroy(res);
+                return NULL;
+            }
+    return res;
+}
+
+int spAdd(void *m1, void *m2, int scale, int mod) {
+    spmatrix *x1 = (spmatrix *) m1, *x2 = (spmatrix *) m2;
+    sprow tmp = {NULL, 0, 0};
+    int i, rcode = SUCCESS;
+    if ((x1->rows != x2->rows) || (x1->cols != x2->cols))
+        return FAILIMPOSSIBLE;
+    for (i = 0; (i < x1->rows) && (SUCCESS == rcode); i++)
+        rcode = spAxpy(x1->row + i, x2->row + i, scale, mod, &tmp);
+    spFreeRow(&tmp);
+    return rcode;
+}
+
+int spCopyRows(void *dst, int startrow, void *src, int from, int nrows) {
+    spmatrix *d = (spmatrix *) dst, *s = (spmatrix *) src;
+    int i;
+    if (d->cols != s->cols) return 0;
+    if (startrow + nrows > d->rows) return 0;
+    for (i = 0; i < nrows; i++)
+        if (SUCCESS != spCopyRow(d->row + startrow + i, s->row + from + i))
+            return 0;
+    return 1;
+}
+
+int spMultFunc(void *res, void *m1, void *m2, int prime) {
+    spmatrix *r = (spmatrix *) res, *a = (spmatrix *) m1, *b = (spmatrix *) m2;
+    spacc acc;
+    int i, k, rcode = SUCCESS;
+    if (SUCCESS != spAccInit(&acc, b->cols)) {
+        spAccFree(&acc);
+        return FAILMEM;
+    }
+    for (i = 0; (i < a->rows) && (SUCCESS == rcode); i++) {
+        sprow *ar = a->row + i;
+        for (k = 0; k < ar->num; k++)
+            if (ar->ent[k].col < b->rows)
+                spAccAdd(&acc, b->row + ar->ent[k].col, ar->ent[k].val, prime);
+        rcode = spAccFlush(&acc, r->row + i);
+    }
+    spAccFree(&acc);
+    return rcode;
+}
+
+void *spTranspose(void *mat) {
+    spmatrix *m = (spmatrix *) mat, *res = spCreate(m->cols, m->rows);
+    int i, k;
+    if (NULL == res) return NULL;
+    for (i = 0; i < m->rows; i++)
+        for (k = 0; k < m->row[i].num; k++)
+            res->row[m->row[i].ent[k].col].alloc++;
+    for (i = 0; i < m->cols; i++) {
+        sprow *r = res->row + i;
+        if (r->alloc && (NULL == (r->ent = (spentry *) mallox(r->alloc * sizeof(spentry))))) {
+            r->alloc = 0;
+            spDestroy(res);
+            return NULL;
+        }
+    }
+    for (i = 0; i < m->rows; i++)
+        for (k = 0; k < m->row[i].num; k++) {
+            sprow *r = res->row + m->row[i].ent[k].col;
+            r->ent[r->num].col = i;
+            r->ent[r->num++].val = m->row[i].ent[k].val;
+        }
+    return res;
+}
+
+static int cmpentry(const void *a, const void *b) {
+    return ((const spentry *) a)->col - ((const spentry *) b)->col;
+}
+
+void *spExtractCols(void *mat, int *idx, int num) {
+    spmatrix *m = (spmatrix *) mat, *res = spCreate(m->rows, num);
+    int *first = NULL, *next = NULL, i, j, k, sorted = 1;
+    if (NULL == res) return NULL;
+    /* new columns that come from column c: first[c], next[first[c]], ... */
+    first = (int *) mallox((m->cols + 1) * sizeof(int));
+    next = (int *) mallox((num + 1) * sizeof(int));
+    if ((NULL == first) || (NULL == next)) goto fail;
+    for (i = 0; i < m->cols; i++) first[i] = -1;
+    for (j = num; j--;) {
+        next[j] = first[idx[j]];
+        first[idx[j]] = j;
+        if ((j > 0) && (idx[j - 1] >= idx[j])) sorted = 0;
+    }
+    for (i = 0; i < m->rows; i++) {
+        sprow *r = m->row + i, *d = res->row + i;
+        for (k = 0; k < r->num; k++)
+            for (j = first[r->ent[k].col]; j >= 0; j = next[j]) {
+                if (SUCCESS != spGrowRow(d, d->num + 1)) goto fail;
+                d->ent[d->num].col = j;
+                d->ent[d->num++].val = r->ent[k].val;
+            }
+        if (!sorted) qsort(d->ent, d->num, sizeof(spentry), cmpentry);
+    }
+    freex(first);
+    freex(next);
+    return res;
+ fail:
+    if (NULL != first) freex(first);
+    if (NULL != next) freex(next);
+    spDestroy(res);
+    return NULL;
+}
+
+void *createSparseMatrixCopy(matrixType *mt, void *mat) {
+    int rows, cols, i, j, val;
+    spmatrix *res;
+    if (sparsematrix == mt) return spCreateCopy(mat);
+    (mt->getDimensions)(mat, &rows, &cols);
+    if (NULL == (res = spCreate(rows, cols))) return NULL;
+    for (i = 0; i < rows; i++) {
+        sprow *r = res->row + i;
+        for (j = 0; j < cols; j++) {
+            if (SUCCESS != (mt->getEntry)(mat, i, j, &val)) {
+                spDestroy(res);
+                return NULL;
+            }
+            if (val) {
+                if (SUCCESS != spGrowRow(r, r->num + 1)) {
+                    spDestroy(res);
+                    return NULL;
+                }
+                r->ent[r->num].col = j;
+                r->ent[r->num++].val = val;
+            }
+        }
+    }
+    return res;
+}
+
+/**** STRUCTURED ELIMINATION ************************************************/
+
+/* rows and columns are kept in doubly linked lists by their number of
+ * entries, so that the ones of lowest count are found quickly */
+typedef struct {
+    int *head, *next, *prev;
+} spbuckets;
+
+static void bkInsert(spbuckets *b, int i, int k) {
+    b->prev[i] = -1;
+    b->next[i] = b->head[k];
+    if (b->head[k] >= 0) b->prev[b->head[k]] = i;
+    b->head[k] = i;
+}
+
+static void bkRemove(spbuckets *b, int i, int k) {
+    if (b->prev[i] >= 0) b->next[b->prev[i]] = b->next[i]; else b->head[k] = b->next[i];
+    if (b->next[i] >= 0) b->prev[b->next[i]] = b->prev[i];
+}
+
+/* a list of rows; may contain rows that have left the column since */
+typedef struct {
+    int *idx;
+    int num, alloc;
+} spilist;
+
+static int spListAdd(spilist *l, int i) {
+    if (l->num == l->alloc) {
+        int nal = l->alloc + l->alloc / 2 + 4;
+        int *aux = (int *) reallox(l->idx, nal * sizeof(int));
+        if (NULL == aux) return FAILMEM;
+        l->idx = aux;
+        l->alloc = nal;
+    }
+    l->idx[l->num++] = i;
+    return SUCCESS;
+}
+
+typedef struct {
+    primeInfo *pi;
+    int prime;
+    spmatrix *a, *u;     /* the matrix and its companion (or NULL) */
+    char *active;        /* rows that are neither pivot rows nor zero */
+    int  *colcnt;        /* number of active rows with an entry in a column */
+    spilist *col;        /* rows with an entry in a column */
+    spbuckets rb, cb;    /* active rows and columns by their count */
+    int ract, cact;      /* number of active rows and nonempty columns */
+    long long nnz;       /* number of entries in active rows */
+    sprow tmp;           /* scratch row for the row operations */
+} spelim;
+
+static void spElimFree(spelim *el) {
+    int i;
+    if (NULL != el->col) {
+        for (i = 0; i < el->a->cols; i++)
+            if (NULL != el->col[i].idx) freex(el->col[i].idx);
+        freex(el->col);
+    }
+    if (NULL != el->active) freex(el->active);
+    if (NULL != el->colcnt) freex(el->colcnt);
+    if (NULL != el->rb.head) freex(el->rb.head);
+    if (NULL != el->rb.next) freex(el->rb.next);
+    if (NULL != el->rb.prev) freex(el->rb.prev);
+    if (NULL != el->cb.head) freex(el->cb.head);
+    if (NULL != el->cb.next) freex(el->cb.next);
+    if (NULL != el->cb.prev) freex(el->cb.prev);
+    spFreeRow(&el->tmp);
+}
+
+/* the entries of a must be reduced */
+static int spElimInit(spelim *el, primeInfo *pi, spmatrix *a, spmatrix *u) {
+    int rows = a->rows, cols = a->cols, i, k;
+
+    memset(el, 0, sizeof(spelim));
+    el->pi = pi;
+    el->prime = pi->prime;
+    el->a = a;
+    el->u = u;
+
+    el->active = (char *) callox(rows + 1, 1);
+    el->colcnt = (int *) callox(cols + 1, sizeof(int));
+    el->col = (spilist *) callox(cols + 1, sizeof(spilist));
+    el->rb.head = (int *) mallox((cols + 1) * sizeof(int));
+    el->rb.next = (int *) mallox((rows + 1) * sizeof(int));
+    el->rb.prev = (int *) mallox((rows + 1) * sizeof(int));
+    el->cb.head = (int *) mallox((rows + 1) * sizeof(int));
+    el->cb.next = (int *) mallox((cols + 1) * sizeof(int));
+    el->cb.prev = (int *) mallox((cols + 1) * sizeof(int));
+    if ((NULL == el->active) || (NULL == el->colcnt) || (NULL == el->col)
+        || (NULL == el->rb.head) || (NULL == el->rb.next) || (NULL == el->rb.prev)
+        || (NULL == el->cb.head) || (NULL == el->cb.next) || (NULL == el->cb.prev))
+        return FAILMEM;
+
+    memset(el->rb.head, 0xff, (cols + 1) * sizeof(int));
+    memset(el->cb.head, 0xff, (rows + 1) * sizeof(int));
+
+    for (i = 0; i < rows; i++) {
+        sprow *r = a->row + i;
+        if (0 == r->num) continue;
+        el->active[i] = 1;
+        el->ract++;
+        el->nnz += r->num;
+        bkInsert(&el->rb, i, r->num);
+        for (k = 0; k < r->num; k++)
+            el->colcnt[r->ent[k].col]++;
+    }
+
+    for (i = 0; i < cols; i++) {
+        spilist *l = el->col + i;
+        if (0 == el->colcnt[i]) continue;
+        el->cact++;
+        bkInsert(&el->cb, i, el->colcnt[i]);
+        if (NULL == (l->idx = (int *) mallox(el->colcnt[i] * sizeof(int))))
+            return FAILMEM;
+        l->alloc = el->colcnt[i];
+    }
+
+    for (i = 0; i < rows; i++)
+        for (k = 0; k < a->row[i].num; k++) {
+            spilist *l = el->col + a->row[i].ent[k].col;
+            l->idx[l->num++] = i;
+        }
+
+    return SUCCESS;
+}
+
+static void spColChange(spelim *el, int c, int delta) {
+    int k = el->colcnt[c];
+    if (k > 0) bkRemove(&el->cb, c, k);
+    el->colcnt[c] = k + delta;
+    if (k + delta > 0) bkInsert(&el->cb, c, k + delta);
+    el->cact += (k + delta > 0) - (k > 0);
+}
+
+/* row s += f * (pivot row r), keeping track of the counts; the
+ * companion rows are treated alike */
+static int spElimRow(spelim *el, int s, int r, int f) {
+    sprow *dst = el->a->row + s, *src = el->a->row + r, *tmp = &el->tmp, aux;
+    const spentry *d = dst->ent, *de = d + dst->num;
+    const spentry *q = src->ent, *qe = q + src->num;
+    spentry *t;
+    int old = dst->num, prime = el->prime;
+
+    if (SUCCESS != spGrowRow(tmp, dst->num + src->num)) return FAILMEM;
+    for (t = tmp->ent; (d < de) || (q < qe);) {
+        if ((q == qe) || ((d < de) && (d->col < q->col))) {
+            *t++ = *d++;
+        } else if ((d == de) || (q->col < d->col)) {
+            /* fill-in */
+            t->col = q->col;
+            t->val = (f * q->val) % prime;
+            t++;
+            spColChange(el, q->col, 1);
+            if (SUCCESS != spListAdd(el->col + q->col, s)) return FAILMEM;
+            q++;
+        } else {
+            int v = (d->val + f * q->val) % prime;
+            if (v) {
+                t->col = d->col; t->val = v; t++;
+            } else {
+                spColChange(el, d->col, -1);
+            }
+            d++; q++;
+        }
+    }
+    tmp->num = t - tmp->ent;
+    aux = *dst; *dst = *tmp; *tmp = aux;
+
+    el->nnz += dst->num - old;
+    bkRemove(&el->rb, s, old);
+    if (dst->num > 0) bkInsert(&el->rb, s, dst->num);
+
+    if (NULL != el->u)
+        return spAxpy(el->u->row + s, el->u->row + r, f, prime, tmp);
+    return SUCCESS;
+}
+
+/* Markowitz search among the columns and rows of lowest count */
+static void spFindPivot(spelim *el, int *pr, int *pc) {
+    spmatrix *a = el->a;
+    long long best = LLONG_MAX, cost;
+    int k, c, s, i, seen = 0, kmax = MAX(a->rows, a->cols);
+
+    for (k = 1; k <= kmax; k++) {
+        if (k <= a->rows)
+            for (c = el->cb.head[k]; c >= 0; c = el->cb.next[c]) {
+                spilist *l = el->col + c;
+                int n = 0;
+                for (i = 0; i < l->num; i++) {
+                    sprow *r;
+                    int j;
+                    s = l->idx[i];
+                    if (!el->active[s]) continue;
+                    r = a->row + s;
+                    j = spFind(r, c);
+                    if ((j == r->num) || (r->ent[j].col != c)) continue;
+                    l->idx[n++] = s; /* drop stale entries on the way */
+                    cost = (long long) (r->num - 1) * (k - 1);
+                    if (cost < best) {
+                        best = cost; *pr = s; *pc = c;
+                    }
+                }
+                l->num = n;
+                if ((0 == best) || (++seen >= SPSEARCH)) return;
+            }
+        if (k <= a->cols)
+            for (s = el->rb.head[k]; s >= 0; s = el->rb.next[s]) {
+                sprow *r = a->row + s;
+                for (i = 0; i < r->num; i++) {
+                    cost = (long long) (k - 1) * (el->colcnt[r->ent[i].col] - 1);
+                    if (cost < best) {
+                        best = cost; *pr = s; *pc = r->ent[i].col;
+                    }
+                }
+                if ((0 == best) || (++seen >= SPSEARCH)) return;
+            }
+        /* the pivots that have not been looked at cost at least k^2 */
+        if (best <= (long long) k * k) return;
+    }
+}
+
+/* make (r,c) a pivot: eliminate column c from the other active rows */
+static int spPivot(spelim *el, int r, int c, int *zer, int *nzer) {
+    sprow *pr = el->a->row + r;
+    spilist *l = el->col + c;
+    int prime = el->prime, inv, i, k, rcode;
+
+    el->active[r] = 0;
+    el->ract--;
+    el->nnz -= pr->num;
+    bkRemove(&el->rb, r, pr->num);
+    for (k = 0; k < pr->num; k++)
+        spColChange(el, pr->ent[k].col, -1);
+
+    inv = el->pi->inverse[(unsigned) pr->ent[spFind(pr, c)].val];
+
+    for (i = 0; i < l->num; i++) {
+        int s = l->idx[i];
+        sprow *sr = el->a->row + s;
+        if (!el->active[s]) continue;
+        k = spFind(sr, c);
+        if ((k == sr->num) || (sr->ent[k].col != c)) continue;
+        rcode = spElimRow(el, s, r, prime - (sr->ent[k].val * inv) % prime);
+        if (SUCCESS != rcode) return rcode;
+        if (0 == sr->num) {
+            el->active[s] = 0;
+            el->ract--;
+            zer[(*nzer)++] = s;
+        }
+    }
+    l->num = 0;
+
+    return SUCCESS;
+}
+
+/* the nonzero entries of row r of the dense matrix d of type dt */
+static int spDenseRow(matrixType *dt, void *d, int r, int cols, int prime,
+                      spentry *res) {
+    int j, n = 0;
+    if (stdmatrix2 == dt) {
+        mat2 *m = (mat2 *) d;
+        const m2word *w = m->data + (size_t) r * m->ipr;
+        for (j = 0; j < m->ipr; j++) {
+            m2word x = w[j];
+            for (; x; x &= x - 1) {
+                int c = j * BITSPERWORD + __builtin_ctzll(x);
+                if (c >= cols) break;
+                res[n].col = c;
+                res[n++].val = 1;
+            }
+        }
+    } else {
+        const cint *row = MATROW((matrix *) d, r);
+        for (j = 0; j < cols; j++) {
+            int v = spmod(row[j], prime);
+            if (v) {
+                res[n].col = j;
+                res[n++].val = v;
+            }
+        }
+    }
+    return n;
+}
+
+/* res = the combination of the companion rows ar[] with the n
+ * coefficients in buf */
+static int spCombine(spelim *el, spacc *acc, const int *ar, const spentry *buf,
+                     int n, sprow *res) {
+    int i;
+    for (i = 0; i < n; i++)
+        spAccAdd(acc, el->u->row + ar[buf[i].col], buf[i].val, el->prime);
+    return spAccFlush(acc, res);
+}
+
+/* eliminate the active rows with the dense code */
+static int spDensePhase(spelim *el, int *piv, int *npiv, int *zer, int *nzer,
+                        int wantkernel, progressInfo *prg) {
+    spmatrix *a = el->a, *u = el->u;
+    matrixType *dt = (2 == el->prime) ? stdmatrix2 : stdmatrix;
+    int *ar = NULL, *cmap = NULL, *ac = NULL, na = 0, nc = 0, rp = 0, rk = 0;
+    int i, j, k, n, aux, rcode = FAILMEM;
+    void *d = NULL, *ker = NULL, *urb = NULL;
+    spentry *buf = NULL;
+    sprow *nrow = NULL, *ncomp = NULL;
+    spacc acc = {NULL, NULL, NULL, 0, 0};
+
+    ar = (int *) mallox((el->ract + 1) * sizeof(int));
+    ac = (int *) mallox((el->cact + 1) * sizeof(int));
+    cmap = (int *) mallox((a->cols + 1) * sizeof(int));
+    if ((NULL == ar) || (NULL == ac) || (NULL == cmap)) goto done;
+
+    for (i = 0; i < a->rows; i++)
+        if (el->active[i]) ar[na++] = i;
+    for (j = 0; j < a->cols; j++)
+        if (el->colcnt[j] > 0) {
+            cmap[j] = nc;
+            ac[nc++] = j;
+        }
+
+    if (NULL == (d = dt->createMatrix(na, nc))) goto done;
+    for (i = 0; i < na; i++) {
+        sprow *r = a->row + ar[i];
+        for (k = 0; k < r->num; k++)
+            dt->setEntry(d, i, cmap[r->ent[k].col], r->ent[k].val);
+    }
+
+    ker = dt->orthoFunc(el->pi, d, (NULL != u) ? &urb : NULL,
+                        (NULL != u) && wantkernel, prg);
+    if ((NULL != prg) && (NULL != prg->interruptVar) && *(prg->interruptVar)) {
+        rcode = FAIL;
+        goto done;
+    }
+    if ((NULL != u) && (NULL == urb)) goto done;
+    if ((NULL != u) && wantkernel && (NULL == ker)) goto done;
+
+    dt->getDimensions(d, &rp, &aux);
+    if (NULL != ker) dt->getDimensions(ker, &rk, &aux);
+
+    buf = (spentry *) mallox((MAX(na, nc) + 1) * sizeof(spentry));
+    nrow = (sprow *) callox(rp + 1, sizeof(sprow));
+    ncomp = (sprow *) callox(rp + rk + 1, sizeof(sprow));
+    if ((NULL == buf) || (NULL == nrow) || (NULL == ncomp)) goto done;
+    if ((NULL != u) && (SUCCESS != spAccInit(&acc, u->cols))) goto done;
+
+    for (i = 0; i < rp; i++) {
+        n = spDenseRow(dt, d, i, nc, el->prime, buf);
+        if (SUCCESS != spGrowRow(nrow + i, n)) goto done;
+        for (k = 0; k < n; k++) {
+            nrow[i].ent[k].col = ac[buf[k].col];
+            nrow[i].ent[k].val = buf[k].val;
+        }
+        nrow[i].num = n;
+        if (NULL != u) {
+            n = spDenseRow(dt, urb, i, na, el->prime, buf);
+            if (SUCCESS != spCombine(el, &acc, ar, buf, n, ncomp + i)) goto done;
+        }
+    }
+    for (i = 0; i < rk; i++) {
+        n = spDenseRow(dt, ker, i, na, el->prime, buf);
+        if (SUCCESS != spCombine(el, &acc, ar, buf, n, ncomp + rp + i)) goto done;
+    }
+
+    /* the slots of the active rows now take the results */
+    for (i = 0; i < na; i++) {
+        int s = ar[i];
+        spFreeRow(a->row + s);
+        if (i < rp) {
+            a->row[s] = nrow[i];
+            piv[(*npiv)++] = s;
+        }
+        if (NULL != u) {
+            spFreeRow(u->row + s);
+            if (i < rp + rk) u->row[s] = ncomp[i];
+        }
+        if ((i >= rp) && (i < rp + rk))
+            zer[(*nzer)++] = s;
+        el->active[s] = 0;
+    }
+    el->ract = 0;
+    freex(nrow); nrow = NULL;
+    freex(ncomp); ncomp = NULL;
+
+    rcode = SUCCESS;
+
+ done:
+    if (NULL != nrow) {
+        for (i = 0; i < rp; i++) spFreeRow(nrow + i);
+        freex(nrow);
+    }
+    if (NULL != ncomp) {
+        for (i = 0; i < rp + rk; i++) spFreeRow(ncomp + i);
+        freex(ncomp);
+    }
+    spAccFree(&acc);
+    if (NULL != buf) freex(buf);
+    if (NULL != d) dt->destroyMatrix(d);
+    if (NULL != ker) dt->destroyMatrix(ker);
+    if (NULL != urb) dt->destroyMatrix(urb);
+    if (NULL != ar) freex(ar);
+    if (NULL != ac) freex(ac);
+    if (NULL != cmap) freex(cmap);
+    return rcode;
+}
+
+/* Eliminate the rows of el->a. The pivot rows are listed in piv[], in the
+ * order in which they have been chosen, the rows that have become zero in
+ * zer[]. Every row operation is repeated on the companion el->u. */
+static int spEliminate(spelim *el, int *piv, int *npiv, int *zer, int *nzer,
+                       int wantkernel, progressInfo *prg) {
+    int rows = el->a->rows, fill = (2 == el->prime) ? SPFILL2 : SPFILL;
+    int failure = 1, r = 0, c = 0, rcode = SUCCESS;
+    PROGINFO(prg);
+
+    *npiv = *nzer = 0;
+    for (r = 0; r < rows; r++)
+        if (!el->active[r]) zer[(*nzer)++] = r;
+
+    PROGVARINIT;
+
+    while (el->ract > 0) {
+        if ((double) el->nnz * fill >= (double) el->ract * el->cact)
+            break;
+        if ((NULL != progvar) && (0 == (*npiv & pmsk))) {
+            perc = *npiv + *nzer; perc /= rows;
+            PROGVARSET(perc);
+        }
+        spFindPivot(el, &r, &c);
+        if (SUCCESS != (rcode = spPivot(el, r, c, zer, nzer)))
+            goto done;
+        piv[(*npiv)++] = r;
+    }
+
+    failure = 0;
+
+ done:
+    PROGVARDONE;
+
+    if (failure)
+        return (SUCCESS != rcode) ? rcode : FAIL;
+
+    if (el->ract > 0)
+        return spDensePhase(el, piv, npiv, zer, nzer, wantkernel, prg);
+
+    return SUCCESS;
+}
+
+/* Orthonormalize a, whose entries must be reduced. Only the pivot rows
+ * remain in a; *urb expresses them in terms of the original rows, and
+ * *ker is the kernel. urb and ker can be NULL. */
+static int spOrthoWork(primeInfo *pi, spmatrix *a, spmatrix **urb,
+                       spmatrix **ker, progressInfo *prg) {
+    int rows = a->rows, npiv = 0, nzer = 0, *piv, *zer, i, rcode = FAILMEM;
+    spmatrix *u = NULL;
+    spelim el;
+
+    if (NULL != urb) *urb = NULL;
+    if (NULL != ker) *ker = NULL;
+
+    piv = (int *) mallox((rows + 1) * sizeof(int));
+    zer = (int *) mallox((rows + 1) * sizeof(int));
+    if ((NULL == piv) || (NULL == zer)) goto done;
+
+    if ((NULL != urb) || (NULL != ker)) {
+        if (NULL == (u = spCreate(rows, rows))) goto done;
+        for (i = 0; i < rows; i++) {
+            if (SUCCESS != spGrowRow(u->row + i, 1)) goto done;
+            u->row[i].ent[0].col = i;
+            u->row[i].ent[0].val = 1;
+            u->row[i].num = 1;
+        }
+    }
+
+    if (SUCCESS == (rcode = spElimInit(&el, pi, a, u)))
+        rcode = spEliminate(&el, piv, &npiv, zer, &nzer, NULL != ker, prg);
+    spElimFree(&el);
+    if (SUCCESS != rcode) goto done;
+
+    rcode = FAILMEM;
+    if ((NULL != urb) && (NULL == (*urb = spTakeRows(u, piv, npiv)))) goto done;
+    if ((NULL != ker) && (NULL == (*ker = spTakeRows(u, zer, nzer)))) goto done;
+    rcode = spKeepRows(a, piv, npiv);
+
+ done:
+    if (SUCCESS != rcode) {
+        if ((NULL != ker) && (NULL != *ker)) {
+            spDestroy(*ker);
+            *ker = NULL;
+        }
+        /* the caller always gets a base change matrix */
+        if ((NULL != urb) && (NULL == *urb)) *urb = spCreate(0, rows);
+    }
+    if (NULL != u) spDestroy(u);
+    if (NULL != piv) freex(piv);
+    if (NULL != zer) freex(zer);
+    return rcode;
+}
+
+/* the pivot columns of the rows of an orthonormalized matrix, see above;
+ * pcol[j] = -1 for rows that vanish */
+static int spPivots(spmatrix *m, int cols, int prime, int *pcol) {
+    char *mark = (char *) callox(cols + 1, 1);
+    int j, k;
+    if (NULL == mark) return FAILMEM;
+    for (j = m->rows; j--;) {
+        sprow *r = m->row + j;
+        pcol[j] = -1;
+        for (k = 0; k < r->num; k++) {
+            int c = r->ent[k].col;
+            if ((c < cols) && !mark[c] && spmod(r->ent[k].val, prime)) {
+                pcol[j] = c;
+                break;
+            }
+        }
+        for (k = 0; k < r->num; k++)
+            if ((r->ent[k].col < cols) && spmod(r->ent[k].val, prime))
+                mark[r->ent[k].col] = 1;
+    }
+    freex(mark);
+    return SUCCESS;
+}
+
+/* a binary heap of row numbers */
+typedef struct {
+    int *dat;
+    int num, alloc;
+} spheap;
+
+static int heapPush(spheap *h, int v) {
+    int i;
+    if (h->num == h->alloc) {
+        int nal = h->alloc + h->alloc / 2 + 16;
+        int *aux = (int *) reallox(h->dat, nal * sizeof(int));
+        if (NULL == aux) return FAILMEM;
+        h->dat = aux;
+        h->alloc = nal;
+    }
+    for (i = h->num++; (i > 0) && (h->dat[(i - 1) / 2] > v); i = (i - 1) / 2)
+        h->dat[i] = h->dat[(i - 1) / 2];
+    h->dat[i] = v;
+    return SUCCESS;
+}
+
+static int heapPop(spheap *h) {
+    int res = h->dat[0], v = h->dat[--(h->num)], i = 0, c;
+    while ((c = 2 * i + 1) < h->num) {
+        if ((c + 1 < h->num) && (h->dat[c + 1] < h->dat[c])) c++;
+        if (v <= h->dat[c]) break;
+        h->dat[i] = h->dat[c];
+        i = c;
+    }
+    h->dat[i] = v;
+    return res;
+}
+
+/* Reduce the rows of tgt by the orthonormalized src. If res is not NULL,
+ * *res receives the coefficients of the reductions, expressed through
+ * the rows of bas (which correspond to the rows of src). */
+static int spReduceBy(primeInfo *pi, spmatrix *tgt, spmatrix *src,
+                      spmatrix *bas, spmatrix **res, progressInfo *prg) {
+    int cols = tgt->cols, prime = pi->prime, failure = 1, rcode = FAILMEM;
+    int *pcol = NULL, *pivof = NULL, *pinv = NULL, i, j, k;
+    spacc acc = {NULL, NULL, NULL, 0, 0}, racc = {NULL, NULL, NULL, 0, 0};
+    spheap heap = {NULL, 0, 0};
+    PROGINFO(prg);
+
+    if (NULL != res) *res = NULL;
+
+    pcol = (int *) mallox((src->rows + 1) * sizeof(int));
+    pinv = (int *) mallox((src->rows + 1) * sizeof(int));
+    pivof = (int *) mallox((cols + 1) * sizeof(int));
+    if ((NULL == pcol) || (NULL == pinv) || (NULL == pivof)) goto fail;
+    if (SUCCESS != spPivots(src, cols, prime, pcol)) goto fail;
+    for (i = 0; i < cols; i++) pivof[i] = -1;
+    for (j = 0; j < src->rows; j++)
+        if (pcol[j] >= 0) {
+            sprow *r = src->row + j;
+            pivof[pcol[j]] = j;
+            pinv[j] = pi->inverse[spmod(r->ent[spFind(r, pcol[j])].val, prime)];
+        }
+
+    if (SUCCESS != spAccInit(&acc, cols)) goto fail;
+    if (NULL != res) {
+        if (SUCCESS != spAccInit(&racc, bas->cols)) goto fail;
+        if (NULL == (*res = spCreate(tgt->rows, bas->cols))) goto fail;
+    }
+
+    {
+        PROGVARINIT;
+
+        for (i = 0; i < tgt->rows; i++) {
+            sprow *t = tgt->row + i;
+            int last = -1;
+
+            if ((NULL != progvar) && (0 == (i & pmsk))) {
+                perc = i; perc /= tgt->rows;
+                PROGVARSET(perc);
+            }
+
+            heap.num = 0;
+            for (k = 0; k < t->num; k++) {
+                int c = t->ent[k].col, v = spmod(t->ent[k].val, prime);
+                spAccSet(&acc, c, v);
+                if (v && (pivof[c] >= 0) && (SUCCESS != heapPush(&heap, pivof[c])))
+                    goto done;
+            }
+
+            /* use the pivot rows in their order */
+            while (heap.num) {
+                sprow *r;
+                int g, v;
+                j = heapPop(&heap);
+                if ((j <= last) || (0 == (v = acc.val[pcol[j]]))) continue;
+                last = j;
+                g = (v * pinv[j]) % prime;
+                r = src->row + j;
+                for (k = 0; k < r->num; k++) {
+                    int c = r->ent[k].col, old, nw;
+                    if (c >= cols) continue;
+                    old = acc.val[c];
+                    nw = spmod(old - g * r->ent[k].val, prime);
+                    spAccSet(&acc, c, nw);
+                    if ((0 == old) && nw && (pivof[c] > j)
+                        && (SUCCESS != heapPush(&heap, pivof[c])))
+                        goto done;
+                }
+                if ((NULL != res) && (j < bas->rows))
+                    spAccAdd(&racc, bas->row + j, g, prime);
+            }
+
+            if (SUCCESS != spAccFlush(&acc, t)) goto done;
+            if ((NULL != res) && (SUCCESS != spAccFlush(&racc, (*res)->row + i)))
+                goto done;
+        }
+
+        failure = 0;
+    done:
+        PROGVARDONE;
+    }
+
+    rcode = failure ? FAIL : SUCCESS;
+
+ fail:
+    if ((SUCCESS != rcode) && (NULL != res) && (NULL != *res)) {
+        spDestroy(*res);
+        *res = NULL;
+    }
+    spAccFree(&acc);
+    spAccFree(&racc);
+    if (NULL != heap.dat) freex(heap.dat);
+    if (NULL != pcol) freex(pcol);
+    if (NULL != pinv) freex(pinv);
+    if (NULL != pivof) freex(pivof);
+    return rcode;
+}
+
+void *spOrthoFunc(primeInfo *pi, void *inp, void *urb, int wantkernel, progressInfo *prg) {
+    spmatrix *ker = NULL;
+    spReduceMatrix(inp, pi->prime);
+    spOrthoWork(pi, (spmatrix *) inp, (spmatrix **) urb,
+                wantkernel ? &ker : NULL, prg);
+    return ker;
+}
+
+void *spLiftFunc(primeInfo *pi, void *inp, void *lft, void *bas, progressInfo *prg) {
+    spmatrix *res = NULL, *urb = NULL;
+
+    spReduceMatrix(lft, pi->prime);
+
+    if (NULL == bas) {
+        spReduceMatrix(inp, pi->prime);
+        if (SUCCESS != spOrthoWork(pi, (spmatrix *) inp, &urb, NULL, prg)) {
+            if (NULL != urb) spDestroy(urb);
+            return NULL;
+        }
+        bas = urb;
+    }
+
+    spReduceBy(pi, (spmatrix *) lft, (spmatrix *) inp, (spmatrix *) bas, &res, prg);
+
+    if (NULL != urb) spDestroy(urb);
+
+    return res;
+}
+
+void spQuotFunc(primeInfo *pi, void *ker, void *im, progressInfo *prg) {
+    spReduceMatrix(ker, pi->prime);
+    if (SUCCESS == spReduceBy(pi, (spmatrix *) ker, (spmatrix *) im, NULL, NULL, prg))
+        spOrthoWork(pi, (spmatrix *) ker, NULL, NULL, prg);
+}
+
+matrixType sparseMatrixType = {
+    .name          = "sparsematrix",
+    .getEntry      = spGetEntry,
+    .setEntry      = spSetEntry,
+    .addToEntry    = spAddToEntry,
+    .getDimensions = spGetDimensions,
+    .createMatrix  = spCreateMatrix,
+    .createCopy    = spCreateCopy,
+    .destroyMatrix = spDestroyMatrix,
+    .clearMatrix   = spClearMatrix,
+    .unitMatrix    = spUnitMatrix,
+    .reduce        = spReduceMatrix,
+    .iszero        = spIsZero,
+    .shrinkRows    = spShrinkRows,
+    .add           = spAdd,
+    .orthoFunc     = spOrthoFunc,
+    .liftFunc      = spLiftFunc,
+    .quotFunc      = spQuotFunc,
+    .copyRows      = spCopyRows,
+    .multFunc      = spMultFunc,
+    .transpose     = spTranspose,
+    .extractCols   = spExtractCols
+};
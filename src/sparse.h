@@ -0,0 +1,39 @@
+/*
+ * Sparse matrices and structured Gaussian elimination
+ *
+ * Copyright (C) 2005-2018 Christian Nassau <nassau@nullhomotopie.de>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ */
+
+#ifndef SPARSE_DEF
+#define SPARSE_DEF
+
+#include "linwrp.h"
+
+/* A sparse matrix is an array of rows, and a row is the list of its
+ * nonzero entries, ordered by column. As with the stdmatrix the entries
+ * are cints that need not be reduced. */
+
+typedef struct {
+    int  col;
+    cint val;
+} spentry;
+
+typedef struct {
+    spentry *ent;
+    int num, alloc;
+} sprow;
+
+typedef struct {
+    sprow *row;
+    int rows, cols;
+} spmatrix;
+
+/* a new sparse matrix with the entries of mat */
+void *createSparseMatrixCopy(matrixType *mt, void *mat);
+
+#endif
@@ -87,7 +87,7 @@ char extract_entry(__m128i var, unsigned int idx) {
 }
 
 static inline 
-void add_blocks(__m128i *dst,__m128i *src, int nblocks, 
+void add_blocks(__m128i *dst,__m128i *src, size_t nblocks, 
                 int coeff, int p) {
     PRINTMSG("======== add_blocks ==========");
     if (p) { coeff %= p; if (coeff<0) coeff += p; }
@@ -131,7 +131,7 @@ void add_blocks(__m128i *dst,__m128i *src, int nblocks,
 }
 
 static inline 
-void reduce_blocks(__m128i *dt, int numblocks, unsigned int prime) {
+void reduce_blocks(__m128i *dt, size_t numblocks, unsigned int prime) {
     const __m128i zero = _mm_setzero_si128();
 #define DECLAREPSHFT(varname,val) \
     const __m128i varname = ((val)<128) ? _mm_set1_epi8(val) : zero;
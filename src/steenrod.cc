@@ -31,6 +31,7 @@
 #include "hmap.h"
 #include "lepar.h"
 #include "adlin.h"
+#include "parallel.h"
 
 static volatile int SIGNAL_FLAG;
 
@@ -71,8 +72,10 @@ int InterruptibleCmd(ClientData cd, Tcl_Interp *ip,
 char *theprogvar; /* ckalloc'ed name of the progress variable */
 int   theprogmsk; /* progress reporting granularity */
 
-/* Our multiplication callback function. This interprets ma's client
- * data fields as follows:
+/* The summands of a row are collected in the stdpoly ma->resPolyPtr by
+ * stdAddSummandToPoly and then entered into the matrix in one go, so
+ * that their sequence numbers can be looked up in a single batch. This
+ * interprets ma's client data fields as follows:
  *
  *   ma->cd1 = matrixType
  *   ma->cd2 = matrix
@@ -81,39 +84,64 @@ int   theprogmsk; /* progress reporting granularity */
  *   ma->cd5 = number of row that we're currently working on
  */
 
-void addToMatrixCB(struct multArgs *ma, const exmo *smd) {
+static void addSummandsToMatrix(struct multArgs *ma, seqint **seqbuf, int *seqalloc) {
     matrixType *mtp = (matrixType *) ma->cd1;
     void *mat = ma->cd2;
     enumerator *dst = (enumerator *) ma->cd3;
     unsigned row = USGNFROMVPTR(ma->cd5);
-    int idx;
-    int rcode;
     Tcl_Interp *ip = (Tcl_Interp *) ma->TclInterp;
+    exmo *smd;
+    int i, num, idx = -1, rcode;
 
-    /*exmoLog("addToMatrixCB",(exmo*)smd);*/
+    if (SUCCESS != PLgetSummandArray(ma->resPolyType, ma->resPolyPtr, &smd, &num)
+        || 0 == num)
+        return;
 
-    idx = SeqnoFromEnum(dst, (exmo *) smd);
+    if (num > *seqalloc) {
+        seqint *aux = (seqint *) reallox(*seqbuf, num * sizeof(seqint));
+        if (NULL == aux) {
+            ma->cd4 = VPTRFROMUSGN(FAILMEM);
+            return;
+        }
+        *seqbuf = aux;
+        *seqalloc = num;
+    }
 
-    if (idx < 0) {
-      //return; // FIXME: optionally (?) ignore seqno errors
-        ma->cd4 = (void *) FAIL;
-        goto error;
+    if (SUCCESS != (rcode = SeqnoFromEnumBatch(dst, smd, num, *seqbuf))) {
+        ma->cd4 = VPTRFROMUSGN(rcode);
+        return;
     }
 
-    /* TODO: support optional checking whether dst[idx] really equals *smd */
+    for (i=0;i<num;i++,smd++) {
 
-    rcode = mtp->addToEntry(mat, row, idx, smd->coeff, ma->prime);
+        /* TODO: support optional checking whether dst[idx] really equals *smd */
 
-    if (SUCCESS == rcode)
-        return;
+        if ((*seqbuf)[i] < 0) {
+            //continue; // FIXME: optionally (?) ignore seqno errors
+            ma->cd4 = (void *) FAIL;
+            goto error;
+        }
 
-    ma->cd4 = VPTRFROMUSGN(rcode);
+        /* seqnos are below the matrix dimension, so they fit into an int */
+        idx = (int) (*seqbuf)[i];
+        rcode = mtp->addToEntry(mat, row, idx, smd->coeff, ma->prime);
+
+        if (SUCCESS != rcode) {
+            ma->cd4 = VPTRFROMUSGN(rcode);
+            goto error;
+        }
+    }
+
+    PLclear(ma->resPolyType, ma->resPolyPtr);
+    return;
 
  error:
 
+    PLclear(ma->resPolyType, ma->resPolyPtr);
+
     if (NULL != ip) {
         char err[200];
-        Tcl_Obj *aux = Tcl_NewExmoCopyObj((exmo *) smd);
+        Tcl_Obj *aux = Tcl_NewExmoCopyObj(smd);
         sprintf(err,
                 "cannot account for monomial {%s}\n"
                 "    (found sequence number %d)",
@@ -135,6 +163,8 @@ typedef struct {
 
     int srcIspos; /* our exmos should either be all positive or all negative */
 
+    int sparse;   /* whether to produce a sparsematrix */
+
     /* callbacks for going through the exmo; the "void *" points to ourself  */
     exmo *srcx;                  /* read-only pointer to the current exmo */
     int (*firstSource)(void *);  /* start iteration, setup srcx and currow */
@@ -166,7 +196,7 @@ typedef struct {
 /* MakeMatrix carries out the computation that's described in the
  * MatCompTaskInfo argument. */
 
-int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
+static int MakeMatrixWork(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
                progressInfo *pinf, matrixType **mtp, void **mat, int ismotivic) {
 
     int srcdim, dstdim;
@@ -178,6 +208,9 @@ int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
     multArgs ourMA, *ma = &ourMA;
     enumerator *dst = mc->dst;
     momap *map = mc->map;
+    void *rowpoly;
+    seqint *seqbuf = NULL, dim;
+    int seqalloc = 0;
 
     double perc; /* progress indicator */
 
@@ -193,16 +226,27 @@ int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
         dgispos = 1;
     }
 
+    if (NULL == (rowpoly = PLcreate(stdpoly)))
+        RETERR("out of memory");
+
     theGObj = Tcl_NewExmoObj(&theG);
     INCREFCNT(theGObj);
 
     /* "theGObj"'s (exmo *) always points to the non-dynamic "theG", so don't free it when done */
-#define RELEASEGOBJ { theGObj->typePtr = NULL; DECREFCNT(theGObj); }
+#define RELEASEGOBJ { theGObj->typePtr = NULL; DECREFCNT(theGObj); \
+                     PLfree(stdpoly, rowpoly); if (NULL != seqbuf) freex(seqbuf); }
 
     srcdim = mc->srcdim;
-    dstdim = DimensionFromEnum(dst);
+    if (!SEQINTFITS(dim = DimensionFromEnum(dst))) {
+        RELEASEGOBJ;
+        RETERR((dim < 0) ? "cannot compute target dimension"
+               : "target dimension too large for a matrix");
+    }
+    dstdim = (int) dim;
 
-    if (2 == dst->pi->prime) {
+    if (mc->sparse) {
+        *mtp = sparsematrix;
+    } else if (2 == dst->pi->prime) {
         *mtp = stdmatrix2;
     } else {
         *mtp = stdmatrix;
@@ -237,7 +281,9 @@ int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
     ma->cd4 = SUCCESS;
     ma->cd5 = (void *) -1;
     ma->TclInterp = ip;
-    ma->stdSummandFunc = &addToMatrixCB;
+    ma->resPolyType = stdpoly;
+    ma->resPolyPtr = rowpoly;
+    ma->stdSummandFunc = &stdAddSummandToPoly;
 
     PROGVARINIT;
 
@@ -314,6 +360,8 @@ int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
             else
                 workAPchain(ma);
 
+            addSummandsToMatrix(ma, &seqbuf, &seqalloc);
+
             multCount += dgnumsum;
 
             if (SUCCESS != USGNFROMVPTR(ma->cd4)) {
@@ -338,6 +386,18 @@ int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
     return SUCCESS;
 }
 
+/* All polynomials and monomials that are created while the matrix is
+ * computed come from a private arena that is released in one go. */
+
+int MakeMatrix(Tcl_Interp *ip, MatCompTaskInfo *mc, exmo *profile,
+               progressInfo *pinf, matrixType **mtp, void **mat, int ismotivic) {
+    polyArena *ar = arenaCreate(), *prev = arenaEnter(ar);
+    int rcode = MakeMatrixWork(ip, mc, profile, pinf, mtp, mat, ismotivic);
+    arenaLeave(prev);
+    arenaRelease(ar);
+    return rcode;
+}
+
 /* --------- MakeMatrixSameSig */
 
 int MCTfsourceEnum(void *s) {
@@ -355,15 +415,20 @@ int MCTnsourceEnum(void *s) {
 }
 
 int MakeMatrixSameSig(Tcl_Interp *ip, enumerator *src, momap *map, enumerator *dst,
-                      progressInfo *pinf, matrixType **mtp, void **mat) {
+                      int sparse, progressInfo *pinf, matrixType **mtp, void **mat) {
     MatCompTaskInfo mct;
+    seqint dim;
 
     /* check whether src and target are compatible */
     if ((NULL == src->pi) || (src->pi != dst->pi))
         RETERR("prime mismatch");
 
     mct.srcIspos = src->ispos;
-    mct.srcdim = DimensionFromEnum(src);
+    mct.sparse = sparse;
+    if (!SEQINTFITS(dim = DimensionFromEnum(src)))
+        RETERR((dim < 0) ? "cannot compute source dimension"
+               : "source dimension too large for a matrix");
+    mct.srcdim = (int) dim;
 
     mct.cd1 = (void *) src;
     mct.srcx = &(src->theex);
@@ -384,10 +449,16 @@ int TMakeMatrixSameSig(ClientData cd, Tcl_Interp *ip,
     progressInfo info, *infoptr;
     matrixType *mtp;
     void *mat;
+    int sparse = 0;
+
+    if ((objc > 1) && (0 == strcmp(Tcl_GetString(objv[1]), "-sparse"))) {
+        sparse = 1;
+        objc--; objv++;
+    }
 
     if ((objc<4) || (objc>6)) {
-        Tcl_WrongNumArgs(ip, 1, objv,
-                         "<enumerator> <monomap> <enumerator> ?<varname>? ?<int>?");
+        Tcl_WrongNumArgs(ip, 1, objv - sparse,
+                         "?-sparse? <enumerator> <monomap> <enumerator> ?<varname>? ?<int>?");
         return TCL_ERROR;
     }
 
@@ -420,7 +491,7 @@ int TMakeMatrixSameSig(ClientData cd, Tcl_Interp *ip,
         return TCL_ERROR;
     }
 
-    if (SUCCESS != MakeMatrixSameSig(ip, src, map, dst, infoptr, &mtp, &mat)) {
+    if (SUCCESS != MakeMatrixSameSig(ip, src, map, dst, sparse, infoptr, &mtp, &mat)) {
         if (NULL != mat) mtp->destroyMatrix(mat);
         return TCL_ERROR;
     }
@@ -534,6 +605,7 @@ int MakeImages(Tcl_Interp *ip, Tcl_Obj *plist, momap *map, enumerator *dst,
 
     mct.srcIspos = pcs.ispos;
     mct.srcdim = pcs.npoly;
+    mct.sparse = 0;
 
     mct.cd1 = &pcs;
     mct.srcx = &(pcs.xm);
@@ -655,6 +727,126 @@ int StealStringRep(ClientData cd, Tcl_Interp *ip,
     return TCL_OK;
 }
 
+/* Large polynomials, matrices and vectors have a compact string
+ * representation if steenrod::_strlimit is set. The full list text
+ * can then be obtained with
+ *
+ *   fulltext <object>                        - returns the text as a list
+ *   fulltext <object> <chunksize> <command>  - evaluates the command with
+ *                                              successive chunks of the list
+ */
+
+#define FULLTEXTCOMMAND POLYNSP "fulltext"
+
+typedef Tcl_Obj *(fullTextRange)(Tcl_Obj *obj, int first, int num);
+
+static int FullTextType(Tcl_Interp *ip, Tcl_Obj *obj,
+                        fullTextRange **range, int *num) {
+    if (!Tcl_ObjIsPoly(obj) && !Tcl_ObjIsMatrix(obj) && !Tcl_ObjIsVector(obj)) {
+        int llen, rc = TCL_OK;
+        Tcl_Obj **lobjv;
+        if (TCL_OK == Tcl_ListObjGetElements(NULL, obj, &llen, &lobjv)
+            && llen > 0) {
+            if (isCompactTag(lobjv[0], "@poly"))
+                rc = Tcl_ConvertToPoly(ip, obj);
+            else if (isCompactTag(lobjv[0], "@matrix")
+                     || isCompactTag(lobjv[0], "@matrix2"))
+                rc = Tcl_ConvertToMatrix(ip, obj);
+            else if (isCompactTag(lobjv[0], "@vector"))
+                rc = Tcl_ConvertToVector(ip, obj);
+        }
+        if (TCL_OK != rc)
+            return TCL_ERROR;
+    }
+
+    *range = NULL;
+    *num = 0;
+
+    if (Tcl_ObjIsPoly(obj)) {
+        *range = Tcl_NewListFromPolyRange;
+        *num = PLgetNumsum(polyTypeFromTclObj(obj), polyFromTclObj(obj));
+    } else if (Tcl_ObjIsMatrix(obj)) {
+        int cols;
+        *range = Tcl_NewListFromMatrixRows;
+        (matrixTypeFromTclObj(obj)->getDimensions)(matrixFromTclObj(obj),
+                                                   num, &cols);
+    } else if (Tcl_ObjIsVector(obj)) {
+        *range = Tcl_NewListFromVectorRange;
+        *num = (vectorTypeFromTclObj(obj)->getLength)(vectorFromTclObj(obj));
+    }
+
+    return TCL_OK;
+}
+
+int FullTextCmd(ClientData cd, Tcl_Interp *ip,
+                int objc, Tcl_Obj * const objv[]) {
+    fullTextRange *range;
+    Tcl_Obj *obj, **cmdv, **cmd;
+    int num, chunk, cmdc, first, rc = TCL_OK;
+
+    if (objc != 2 && objc != 4) {
+        Tcl_SetResult(ip, "usage: " FULLTEXTCOMMAND
+                      " <object> ?<chunksize> <command>?", TCL_STATIC);
+        return TCL_ERROR;
+    }
+
+    obj = objv[1];
+
+    if (TCL_OK != FullTextType(ip, obj, &range, &num))
+        return TCL_ERROR;
+
+    if (2 == objc) {
+        Tcl_SetObjResult(ip, (NULL != range) ? (range)(obj, 0, num) : obj);
+        return TCL_OK;
+    }
+
+    if (TCL_OK != Tcl_GetIntFromObj(ip, objv[2], &chunk))
+        return TCL_ERROR;
+    if (chunk < 1) {
+        Tcl_SetResult(ip, "chunk size must be positive", TCL_STATIC);
+        return TCL_ERROR;
+    }
+    if (TCL_OK != Tcl_ListObjGetElements(ip, objv[3], &cmdc, &cmdv))
+        return TCL_ERROR;
+
+    cmd = (Tcl_Obj **) ckalloc((cmdc + 1) * sizeof(Tcl_Obj *));
+    for (first = 0; first < cmdc; first++) {
+        cmd[first] = cmdv[first];
+        INCREFCNT(cmd[first]);
+    }
+    INCREFCNT(obj);
+
+    if (NULL == range) {
+        /* not one of our types: hand out the plain value */
+        cmd[cmdc] = obj;
+        INCREFCNT(obj);
+        rc = Tcl_EvalObjv(ip, cmdc + 1, cmd, 0);
+        DECREFCNT(cmd[cmdc]);
+    } else for (first = 0; first < num; first += chunk) {
+        /* the command might have changed the type of obj */
+        if (TCL_OK != (rc = FullTextType(ip, obj, &range, &num)))
+            break;
+        if (NULL == range || first >= num)
+            break;
+        cmd[cmdc] = (range)(obj, first, (first + chunk <= num) ? chunk : (num - first));
+        INCREFCNT(cmd[cmdc]);
+        rc = Tcl_EvalObjv(ip, cmdc + 1, cmd, 0);
+        DECREFCNT(cmd[cmdc]);
+        if (TCL_CONTINUE == rc) rc = TCL_OK;
+        if (TCL_OK != rc) break;
+    }
+
+    if (TCL_BREAK == rc) rc = TCL_OK;
+    if (TCL_OK == rc) Tcl_ResetResult(ip);
+
+    DECREFCNT(obj);
+    for (first = 0; first < cmdc; first++)
+        DECREFCNT(cmd[first]);
+    ckfree((char *) cmd);
+
+    return rc;
+}
+
 int GetRefCount(ClientData cd, Tcl_Interp *ip,
                 int objc, Tcl_Obj * const objv[]) {
     if (objc != 2) {
@@ -742,6 +934,9 @@ EXTERN int Steenrod_Init(Tcl_Interp *ip) {
     Tcl_CreateObjCommand(ip, STEALCOMMAND,
                          StealStringRep, (ClientData) 0, NULL);
 
+    Tcl_CreateObjCommand(ip, FULLTEXTCOMMAND,
+                         FullTextCmd, (ClientData) 0, NULL);
+
     Tcl_CreateObjCommand(ip, POLYNSP "_refcount",
                          GetRefCount, (ClientData) 0, NULL);
 
@@ -767,6 +962,19 @@ EXTERN int Steenrod_Init(Tcl_Interp *ip) {
 
     theprogvar = (char *) ckalloc(1); *theprogvar = 0; theprogmsk = 0x1;
 
+    /* number of threads for parallel computations */
+    Tcl_UnlinkVar(ip, POLYNSP "_threads");
+    parallelThreads();
+    Tcl_LinkVar(ip, POLYNSP "_threads", (char *) &thethreads, TCL_LINK_INT);
+
+    /* number of rows from which mod 2 eliminations are done recursively */
+    Tcl_UnlinkVar(ip, POLYNSP "_pleminrows");
+    Tcl_LinkVar(ip, POLYNSP "_pleminrows", (char *) &thepleminrows, TCL_LINK_INT);
+
+    /* size above which objects get a compact string representation */
+    Tcl_UnlinkVar(ip, POLYNSP "_strlimit");
+    Tcl_LinkVar(ip, POLYNSP "_strlimit", (char *) &thestrlimit, TCL_LINK_INT);
+
     Tcl_UnlinkVar(ip, POLYNSP "_objCount");
     Tcl_LinkVar(ip, POLYNSP "_objCount", (char *) &objCount, TCL_LINK_INT | TCL_LINK_READ_ONLY);
 
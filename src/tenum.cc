@@ -202,6 +202,19 @@ static const char *optNames[] = { "-prime", "-algebra", "-profile", "-signature"
 static enumoptcode optmap[] = { PRIME, ALGEBRA, PROFILE, SIGNATURE,
                                 TYPE, IDEG, EDEG, HDEG, GENLIST };
 
+/* the generator list of the enumerator, as a list of {id ideg edeg hdeg} */
+static Tcl_Obj *Tcl_EnumGenlistObj(tclEnum *te) {
+    Tcl_Obj *res = Tcl_NewListObj(0, NULL), *gen[4];
+    int i, j, *glp;
+
+    for (i=0,glp=te->enm->genList; i<te->enm->numgens; i++,glp+=4) {
+        for (j=0;j<4;j++) gen[j] = Tcl_NewIntObj(glp[j]);
+        Tcl_ListObjAppendElement(NULL, res, Tcl_NewListObj(4, gen));
+    }
+
+    return res;
+}
+
 /* note that this command differs from the others: it assumes that option value
  * pairs start at objv[0]. */
 int Tcl_EnumConfigureCmd(ClientData cd, Tcl_Interp *ip,
@@ -226,8 +239,8 @@ int Tcl_EnumConfigureCmd(ClientData cd, Tcl_Interp *ip,
         }
 
         if (needsUpdate == te->genlist) {
-            /* TODO: recreate genlist from enum if that has been changed
-             * by a future addgen cmd */
+            te->genlist = Tcl_EnumGenlistObj(te);
+            INCREFCNT(te->genlist);
         }
 
 #define APPENDOPT(name, obj) {                                          \
@@ -397,7 +410,10 @@ int Tcl_EnumCgetCmd(ClientData cd, Tcl_Interp *ip,
         case EDEG:      SETRESRET(te->edeg);
         case HDEG:      SETRESRET(te->hdeg);
         case GENLIST:
-            /* TODO: recreate genlist if addgen had been invoked */
+            if (needsUpdate == te->genlist) {
+                te->genlist = Tcl_EnumGenlistObj(te);
+                INCREFCNT(te->genlist);
+            }
             SETRESRET(te->genlist);
     }
 
@@ -408,10 +424,15 @@ int Tcl_EnumCgetCmd(ClientData cd, Tcl_Interp *ip,
 int Tcl_EnumBasisCmd(ClientData cd, Tcl_Interp *ip,
                       int objc, Tcl_Obj * const objv[]) {
     tclEnum *te = (tclEnum *) cd;
+    polyArena *ar, *prev;
 
     if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
 
-    /* naive implementation: iterate through enum and create list */
+    /* naive implementation: iterate through enum and create list;
+     * the arena lets all temporary monomials share one cell */
+
+    ar = arenaCreate();
+    prev = arenaEnter(ar);
 
     if (firstRedmon(te->enm))
         do {
@@ -420,21 +441,221 @@ int Tcl_EnumBasisCmd(ClientData cd, Tcl_Interp *ip,
             DECREFCNT(aux);
         } while (nextRedmon(te->enm));
 
+    arenaLeave(prev);
+    arenaRelease(ar);
+
+    return TCL_OK;
+}
+
+typedef struct {
+    Tcl_Interp *ip;
+    Tcl_Obj    *var, *body;
+    int         chunk, rc;
+    int         chunked;  /* was -chunk given? then we hand out polys */
+} foreachBasisData;
+
+#define FOREACHSTOP FAIL
+
+static int foreachBasisCB(void *cd, const exmo *ex, int num, seqint seqno) {
+    foreachBasisData *fb = (foreachBasisData *) cd;
+    Tcl_Obj *val;
+
+    if (!fb->chunked) {
+        val = Tcl_NewExmoCopyObj((exmo *) ex);
+    } else {
+        void *pol;
+        int i;
+        if (NULL == (pol = PLcreate(stdpoly))) {
+            Tcl_SetResult(fb->ip, "out of memory", TCL_STATIC);
+            fb->rc = TCL_ERROR;
+            return FOREACHSTOP;
+        }
+        for (i=0; i<num; i++)
+            PLappendExmo(stdpoly, pol, (exmo *) &(ex[i]));
+        val = Tcl_NewPolyObj(stdpoly, pol);
+    }
+
+    if (NULL == Tcl_ObjSetVar2(fb->ip, fb->var, NULL, val, TCL_LEAVE_ERR_MSG)) {
+        fb->rc = TCL_ERROR;
+        return FOREACHSTOP;
+    }
+
+    fb->rc = Tcl_EvalObjEx(fb->ip, fb->body, 0);
+
+    if (TCL_CONTINUE == fb->rc) fb->rc = TCL_OK;
+    if (TCL_ERROR == fb->rc) {
+        char msg[100];
+        sprintf(msg, "\n    (\"foreach-basis\" body line %d)",
+                Tcl_GetErrorLine(fb->ip));
+        Tcl_AddErrorInfo(fb->ip, msg);
+    }
+
+    return (TCL_OK == fb->rc) ? SUCCESS : FOREACHSTOP;
+}
+
+int Tcl_EnumForeachBasisCmd(ClientData cd, Tcl_Interp *ip,
+                            int objc, Tcl_Obj * const objv[]) {
+    tclEnum *te = (tclEnum *) cd;
+    foreachBasisData fb;
+    int rcode;
+
+    fb.chunk = 1;
+    fb.chunked = 0;
+    if (6 == objc) {
+        if (strcmp(Tcl_GetString(objv[3]), "-chunk"))
+            RETERR("expected \"-chunk\"");
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[4], &(fb.chunk)))
+            return TCL_ERROR;
+        if (fb.chunk < 1) RETERR("chunk size must be positive");
+        fb.chunked = 1;
+    } else if (4 != objc) {
+        Tcl_WrongNumArgs(ip, 2, objv, "varName ?-chunk size? body");
+        return TCL_ERROR;
+    }
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    fb.ip   = ip;
+    fb.var  = objv[2];
+    fb.body = objv[objc-1];
+    fb.rc   = TCL_OK;
+
+    Tcl_IncrRefCount(fb.var);
+    Tcl_IncrRefCount(fb.body);
+    rcode = enmForeachBasis(te->enm, fb.chunk, foreachBasisCB, &fb);
+    Tcl_DecrRefCount(fb.var);
+    Tcl_DecrRefCount(fb.body);
+
+    if ((SUCCESS != rcode) && (FOREACHSTOP != rcode))
+        RETERR("out of memory");
+
+    if (TCL_BREAK == fb.rc) fb.rc = TCL_OK;
+    if (TCL_OK == fb.rc) Tcl_ResetResult(ip);
+
+    return fb.rc;
+}
+
+int Tcl_EnumAddgensCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
+    tclEnum *te = (tclEnum *) cd;
+    int *gl, num, rcode;
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    if (TCL_OK != Tcl_ListObjLength(ip, obj, &num)) return TCL_ERROR;
+    if (0 == num) return TCL_OK;
+
+    if (NULL == (gl = getGenList(ip, obj, &num))) return TCL_ERROR;
+
+    rcode = enmAddGens(te->enm, gl, num);
+    freex(gl);
+
+    if (FAILMEM == rcode) RETERR("out of memory");
+    if (SUCCESS != rcode)
+        RETERR("duplicate generator id or decreasing internal degree");
+
+    /* the genlist object is recreated on demand */
+    TRYFREEOBJ(te->genlist);
+    te->genlist = needsUpdate;
+
     return TCL_OK;
 }
 
 int Tcl_EnumDimensionCmd(ClientData cd, Tcl_Interp *ip,
                       int objc, Tcl_Obj * const objv[]) {
     tclEnum *te = (tclEnum *) cd;
-    int res;
+    seqint res;
 
     if (objc != 2) RETERR("too many arguments");
 
     if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
 
-    res = DimensionFromEnum(te->enm);
+    if (SUCCESS != enmDimension(te->enm, &res))
+        RETERR("cannot compute dimension (overflow?)");
+
+    Tcl_SetObjResult(ip, Tcl_NewWideIntObj(res));
+
+    return TCL_OK;
+}
+
+static const char *dimOptNames[] = { "-ideg", "-edeg", "-profile", (char *) NULL };
+
+/* parse a degree range {lo hi}; a single number is also accepted */
+static int getDegreeRange(Tcl_Interp *ip, Tcl_Obj *obj, int *lo, int *hi) {
+    Tcl_Obj **elv;
+    int elc;
+    if (TCL_OK != Tcl_ListObjGetElements(ip, obj, &elc, &elv))
+        return TCL_ERROR;
+    if ((elc < 1) || (elc > 2))
+        RETERR("degree range must have the form {lo hi}");
+    if (TCL_OK != Tcl_GetIntFromObj(ip, elv[0], lo)) return TCL_ERROR;
+    if (TCL_OK != Tcl_GetIntFromObj(ip, elv[elc-1], hi)) return TCL_ERROR;
+    return TCL_OK;
+}
+
+int Tcl_EnumDimensionsCmd(ClientData cd, Tcl_Interp *ip,
+                          int objc, Tcl_Obj * const objv[]) {
+    tclEnum *te = (tclEnum *) cd;
+    int ilo, ihi, elo, ehi, ni, ne, i, j, idx;
+    seqint *res;
+    exmo *pro = NULL;
+    Tcl_Obj **rows, **cols;
+
+    if (0 != (objc & 1)) {
+        Tcl_WrongNumArgs(ip, 2, objv, "?-ideg {lo hi}? ?-edeg {lo hi}? ?-profile profile?");
+        return TCL_ERROR;
+    }
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    ilo = ihi = te->enm->ideg;
+    elo = ehi = te->enm->edeg;
+
+    for (i=2; i<objc; i+=2) {
+        if (TCL_OK != Tcl_GetIndexFromObj(ip, objv[i], dimOptNames,
+                                          "option", 0, &idx))
+            return TCL_ERROR;
+        switch (idx) {
+            case 0:
+                if (TCL_OK != getDegreeRange(ip, objv[i+1], &ilo, &ihi))
+                    return TCL_ERROR;
+                break;
+            case 1:
+                if (TCL_OK != getDegreeRange(ip, objv[i+1], &elo, &ehi))
+                    return TCL_ERROR;
+                break;
+            case 2:
+                if (TCL_OK != Tcl_ConvertToExmo(ip, objv[i+1]))
+                    return TCL_ERROR;
+                pro = exmoFromTclObj(objv[i+1]);
+                break;
+        }
+    }
+
+    ni = ihi - ilo + 1; ne = ehi - elo + 1;
+    if ((ni <= 0) || (ne <= 0)) {
+        Tcl_ResetResult(ip);
+        return TCL_OK;
+    }
+
+    if (NULL == (res = (seqint *) mallox((size_t) ni * ne * sizeof(seqint))))
+        RETERR("out of memory");
+
+    if (SUCCESS != DimensionTableFromEnum(te->enm, pro, ilo, ihi, elo, ehi, res)) {
+        freex(res);
+        RETERR("cannot compute dimensions (overflow?)");
+    }
 
-    Tcl_SetObjResult(ip, Tcl_NewIntObj(res));
+    rows = (Tcl_Obj **) ckalloc(ni * sizeof(Tcl_Obj *));
+    cols = (Tcl_Obj **) ckalloc(ne * sizeof(Tcl_Obj *));
+    for (i=0; i<ni; i++) {
+        for (j=0; j<ne; j++)
+            cols[j] = Tcl_NewWideIntObj(res[i * ne + j]);
+        rows[i] = Tcl_NewListObj(ne, cols);
+    }
+    Tcl_SetObjResult(ip, Tcl_NewListObj(ni, rows));
+    ckfree((char *) cols);
+    ckfree((char *) rows);
+    freex(res);
 
     return TCL_OK;
 }
@@ -443,7 +664,7 @@ int Tcl_EnumSeqnoCmd(ClientData cd, Tcl_Interp *ip, int usemotivic,
 		     int objc, Tcl_Obj * const objv[]) {
   tclEnum *te = (tclEnum *) cd;
   enumerator *enu;
-  int res;
+  seqint res, max;
 
   if (objc != 3) {
     Tcl_WrongNumArgs(ip, 2, objv, "(<monomial> or <enumerator>)");
@@ -455,40 +676,62 @@ int Tcl_EnumSeqnoCmd(ClientData cd, Tcl_Interp *ip, int usemotivic,
   if (!Tcl_ObjIsExmo(objv[2]))
     if (NULL != (enu = Tcl_EnumFromObj(ip, objv[2]))) {
 
-      int max = DimensionFromEnum(te->enm);
-      Tcl_Obj *res = Tcl_NewObj();
+      int num = 0, nalloc = 0, i;
+      seqint *seq = NULL;
+      exmo *dat = NULL;
+      Tcl_Obj *res;
+
+      if (SUCCESS != enmDimension(te->enm, &max))
+	RETERR("cannot compute dimension (overflow?)");
 
+      /* collect the basis of enu, then look it up in one batch */
       if (firstRedmon(enu))
 	do {
-	  int sqn;
-	  exmo aux, *eptr;
-
-	  if(usemotivic) {
-	    copyExmo(&aux,&(enu->theex));
-	    motateExmo(&aux);
-	    eptr = &aux;
-	  } else {
-	    eptr = &(enu->theex);
-	  }
-	  sqn = SeqnoFromEnum(te->enm, eptr);
-
-	  if(sqn<0) {
-	    Tcl_SetResult(ip, "cannot account for monomial ", TCL_STATIC);
-	    Tcl_Obj *e = Tcl_NewExmoCopyObj(eptr);
-	    Tcl_IncrRefCount(e);
-	    Tcl_AppendResult(ip, Tcl_GetString(e), NULL);
-	    Tcl_DecrRefCount(e);
-	    Tcl_DecrRefCount(res);
-	    return TCL_ERROR;
+	  if (num == nalloc) {
+	    exmo *aux;
+	    nalloc += (nalloc >> 1) + 64;
+	    if (NULL == (aux = (exmo *) reallox(dat, nalloc * sizeof(exmo)))) {
+	      if (NULL != dat) freex(dat);
+	      RETERR("out of memory");
+	    }
+	    dat = aux;
 	  }
+	  copyExmo(&(dat[num]), &(enu->theex));
+	  if(usemotivic) motateExmo(&(dat[num]));
+	  num++;
+	} while (nextRedmon(enu));
 
-	  if ((sqn < 0) || (sqn >= max)) sqn = -1;
+      if ((NULL == (seq = (seqint *) mallox((num + 1) * sizeof(seqint))))
+	  || (SUCCESS != SeqnoFromEnumBatch(te->enm, dat, num, seq))) {
+	if (NULL != seq) freex(seq);
+	if (NULL != dat) freex(dat);
+	RETERR("cannot compute sequence numbers");
+      }
 
-	  if (TCL_ERROR == Tcl_ListObjAppendElement(ip, res, Tcl_NewIntObj(sqn))) {
-	    DECREFCNT(res);
-	    return TCL_ERROR;
-	  }
-	} while (nextRedmon(enu));
+      res = Tcl_NewObj();
+
+      for (i=0;i<num;i++) {
+	seqint sqn = seq[i];
+
+	if(sqn<0) {
+	  Tcl_SetResult(ip, "cannot account for monomial ", TCL_STATIC);
+	  Tcl_Obj *e = Tcl_NewExmoCopyObj(&(dat[i]));
+	  Tcl_IncrRefCount(e);
+	  Tcl_AppendResult(ip, Tcl_GetString(e), NULL);
+	  Tcl_DecrRefCount(e);
+	  Tcl_DecrRefCount(res);
+	  freex(seq);
+	  freex(dat);
+	  return TCL_ERROR;
+	}
+
+	if (sqn >= max) sqn = -1;
+
+	Tcl_ListObjAppendElement(ip, res, Tcl_NewWideIntObj(sqn));
+      }
+
+      freex(seq);
+      if (NULL != dat) freex(dat);
 
       Tcl_SetObjResult(ip, res);
       return TCL_OK;
@@ -505,10 +748,117 @@ int Tcl_EnumSeqnoCmd(ClientData cd, Tcl_Interp *ip, int usemotivic,
   } else {
     res = SeqnoFromEnum(te->enm, exmoFromTclObj(objv[2]));
   }
-  Tcl_SetObjResult(ip, Tcl_NewIntObj(res));
+  Tcl_SetObjResult(ip, Tcl_NewWideIntObj(res));
   return TCL_OK;
 }
 
+/* Look up the sequence numbers of all summands of a polynomial in one
+ * batch. *dat is set to the summand array; if *owned is set on return,
+ * *dat is a private copy that must be freed along with *seq. */
+static int Tcl_EnumPolySeqnos(tclEnum *te, Tcl_Interp *ip,
+                              polyType *pt, void *pdat,
+                              exmo **dat, seqint **seq, int *num, int *owned) {
+    int i;
+
+    *owned = 0;
+    if (SUCCESS != PLgetSummandArray(pt, pdat, dat, num)) {
+        *num = PLgetNumsum(pt, pdat);
+        if (NULL == (*dat = (exmo *) mallox((*num + 1) * sizeof(exmo))))
+            RETERR("out of memory");
+        *owned = 1;
+        for (i=0;i<*num;i++)
+            if (SUCCESS != PLgetExmo(pt, pdat, &((*dat)[i]), i)) {
+                freex(*dat);
+                RETERR("internal error in Tcl_EnumPolySeqnos: PLgetExmo failed");
+            }
+    }
+
+    if (NULL == (*seq = (seqint *) mallox((*num + 1) * sizeof(seqint)))) {
+        if (*owned) freex(*dat);
+        RETERR("out of memory");
+    }
+
+    if (SUCCESS != SeqnoFromEnumBatch(te->enm, *dat, *num, *seq)) {
+        if (*owned) freex(*dat);
+        freex(*seq);
+        RETERR("cannot compute sequence numbers");
+    }
+
+    return TCL_OK;
+}
+
+int Tcl_EnumSeqnosCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
+    tclEnum *te = (tclEnum *) cd;
+    exmo *dat;
+    seqint *seq;
+    int num, owned, i;
+    Tcl_Obj **objv;
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    if (TCL_OK != Tcl_EnumPolySeqnos(te, ip, polyTypeFromTclObj(obj),
+                                     polyFromTclObj(obj),
+                                     &dat, &seq, &num, &owned))
+        return TCL_ERROR;
+
+    objv = (Tcl_Obj **) ckalloc((num + 1) * sizeof(Tcl_Obj *));
+    for (i=0;i<num;i++)
+        objv[i] = Tcl_NewWideIntObj(seq[i]);
+    Tcl_SetObjResult(ip, Tcl_NewListObj(num, objv));
+    ckfree((char *) objv);
+
+    if (owned) freex(dat);
+    freex(seq);
+
+    return TCL_OK;
+}
+
+int Tcl_EnumElementCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
+    tclEnum *te = (tclEnum *) cd;
+    Tcl_WideInt seqno;
+    exmo ex;
+
+    if (TCL_OK != Tcl_GetWideIntFromObj(ip, obj, &seqno)) return TCL_ERROR;
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    if ((seqno < 0) || (seqno >= DimensionFromEnum(te->enm)))
+        RETERR("sequence number out of range");
+
+    if (SUCCESS != ExmoFromSeqno(te->enm, seqno, &ex))
+        RETERR("internal error in Tcl_EnumElementCmd");
+
+    Tcl_SetObjResult(ip, Tcl_NewExmoCopyObj(&ex));
+    return TCL_OK;
+}
+
+int Tcl_EnumSigtableCmd(ClientData cd, Tcl_Interp *ip,
+                        int objc, Tcl_Obj * const objv[]) {
+    tclEnum *te = (tclEnum *) cd;
+    Tcl_Obj *res, *ent[3];
+    int i;
+
+    if (objc != 2) RETERR("wrong number of arguments");
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    if (NULL == te->enm->sigtab)
+        if (SUCCESS != enmCreateSigtab(te->enm))
+            RETERR("cannot compute signature table");
+
+    res = Tcl_NewListObj(0, NULL);
+    for (i=0; i<te->enm->siglen; i++) {
+        sigentry *se = &(te->enm->sigtab[i]);
+        ent[0] = Tcl_NewExmoCopyObj(&(se->sig));
+        ent[1] = Tcl_NewWideIntObj(se->dim);
+        ent[2] = Tcl_NewWideIntObj(se->offset);
+        Tcl_ListObjAppendElement(ip, res, Tcl_NewListObj(3, ent));
+    }
+
+    Tcl_SetObjResult(ip, res);
+    return TCL_OK;
+}
+
 int Tcl_EnumSiglistCmd(ClientData cd, Tcl_Interp *ip,
                       int objc, Tcl_Obj * const objv[]) {
     tclEnum *te = (tclEnum *) cd;
@@ -534,11 +884,27 @@ int Tcl_EnumSiglistCmd(ClientData cd, Tcl_Interp *ip,
     return TCL_OK;
 }
 
+/* The dimension of the enumerator, for use as a vector or matrix size. */
+static int Tcl_EnumMatrixDim(tclEnum *te, Tcl_Interp *ip, int *dim) {
+    seqint res;
+
+    if (SUCCESS != enmDimension(te->enm, &res))
+        RETERR("cannot compute dimension (overflow?)");
+    if (!SEQINTFITS(res))
+        RETERR("dimension too large for a vector or matrix");
+    *dim = (int) res;
+    return TCL_OK;
+}
+
+/* use unranking in decode if at most one entry in DECODERATIO is nonzero */
+#define DECODERATIO 8
+#define DECODESPARSE(nnz, dim) ((nnz) * DECODERATIO <= (dim))
+
 int Tcl_EnumDecodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj, int scale) {
     tclEnum *te = (tclEnum *) cd;
     vectorType *vt; void *vdat;
     void *pdat;
-    int vdim, edim, idx, val, prime;
+    int vdim, edim, idx, val, prime, nnz;
 
     if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
 
@@ -552,7 +918,7 @@ int Tcl_EnumDecodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj, int scale) {
     vdat = vectorFromTclObj(obj);
     vdim = vt->getLength(vdat);
 
-    edim = DimensionFromEnum(te->enm);
+    if (TCL_OK != Tcl_EnumMatrixDim(te, ip, &edim)) return TCL_ERROR;
 
     if (vdim != edim) {
         char err[100];
@@ -563,6 +929,39 @@ int Tcl_EnumDecodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj, int scale) {
 
     if (NULL == (pdat = PLcreate(stdpoly))) RETERR("PLcreate failed");
 
+    /* count the nonzero entries; for sparse vectors it is cheaper to
+     * construct the basis elements directly than to walk the basis */
+    for (nnz=idx=0; idx<vdim; idx++)
+        if ((SUCCESS == vt->getEntry(vdat, idx, &val)) && (0 != (val % prime)))
+            nnz++;
+
+    if (DECODESPARSE(nnz, vdim)) {
+        exmo ex;
+        for (idx=0; idx<vdim; idx++) {
+            if (SUCCESS != (vt->getEntry(vdat, idx, &val))) {
+                PLfree(stdpoly, pdat);
+                RETERR("internal error in Tcl_EnumDecodeCmd: vt->getEntry failed");
+            }
+            val *= scale;
+            val %= prime;
+            if (val < 0) val += prime;
+            if (!val) continue;
+            if (SUCCESS != ExmoFromSeqno(te->enm, idx, &ex)) {
+                PLfree(stdpoly, pdat);
+                RETERR("internal error in Tcl_EnumDecodeCmd: "
+                       "ExmoFromSeqno failed");
+            }
+            ex.coeff = val;
+            if (SUCCESS != PLappendExmo(stdpoly, pdat, &ex)) {
+                PLfree(stdpoly, pdat);
+                RETERR("internal error in Tcl_EnumDecodeCmd: "
+                       "PLappendExmo failed");
+            }
+        }
+        Tcl_SetObjResult(ip, Tcl_NewPolyObj(stdpoly, pdat));
+        return TCL_OK;
+    }
+
     idx = 0;
     if (firstRedmon(te->enm))
         do {
@@ -598,12 +997,161 @@ int Tcl_EnumDecodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj, int scale) {
     return TCL_OK;
 }
 
+/* Collect the basis elements for the columns that are flagged in used[];
+ * colex[i] receives the element of the i-th used column. For few columns
+ * the elements are constructed directly, otherwise the basis is walked. */
+static int Tcl_EnumUsedColumns(tclEnum *te, Tcl_Interp *ip, const char *used,
+                               int cols, int nnz, exmo *colex) {
+    int idx, cnt = 0;
+
+    if (DECODESPARSE(nnz, cols)) {
+        for (idx=0; idx<cols; idx++)
+            if (used[idx])
+                if (SUCCESS != ExmoFromSeqno(te->enm, idx, &(colex[cnt++])))
+                    RETERR("internal error in Tcl_EnumUsedColumns: "
+                           "ExmoFromSeqno failed");
+        return TCL_OK;
+    }
+
+    idx = 0;
+    if (firstRedmon(te->enm))
+        do {
+            if (idx >= cols)
+                RETERR("internal error in Tcl_EnumUsedColumns");
+            if (used[idx]) copyExmo(&(colex[cnt++]), &(te->enm->theex));
+            idx++;
+        } while (nextRedmon(te->enm));
+
+    return TCL_OK;
+}
+
+int Tcl_EnumDecodeMatrixCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj, int scale) {
+    tclEnum *te = (tclEnum *) cd;
+    matrixType *mt; void *mdat;
+    int rows, cols, edim, prime, nnz, r, c, val, *colidx, rcode = TCL_OK;
+    char *used;
+    exmo *colex = NULL;
+    Tcl_Obj *res;
+    mat2 *m2 = NULL;
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    prime = te->enm->pi->prime;
+    scale %= prime;
+    if (scale < 0) scale += prime;
+
+    mt   = matrixTypeFromTclObj(obj);
+    mdat = matrixFromTclObj(obj);
+    mt->getDimensions(mdat, &rows, &cols);
+    if (stdmatrix2 == mt) m2 = (mat2 *) mdat;
+
+    if (TCL_OK != Tcl_EnumMatrixDim(te, ip, &edim)) return TCL_ERROR;
+
+    if (cols != edim) {
+        char err[100];
+        sprintf(err,"dimension mismatch: %d (matrix) != %d (enumerator)",
+                cols, edim);
+        RETERR(err);
+    }
+
+    if (NULL == (used = (char *) callox(cols + 1, 1)))
+        RETERR("out of memory");
+    if (NULL == (colidx = (int *) mallox((cols + 1) * sizeof(int)))) {
+        freex(used);
+        RETERR("out of memory");
+    }
+
+    /* find the nonzero columns */
+    if (0 == scale) {
+        /* every row decodes to zero */
+    } else if (NULL != m2) {
+        for (r=0; r<rows; r++) {
+            const m2word *rw = m2->data + r * m2->ipr;
+            for (c=0; c<cols; c++)
+                if (rw[c / BITSPERWORD] & (((m2word) 1) << (c % BITSPERWORD)))
+                    used[c] = 1;
+        }
+    } else {
+        for (r=0; r<rows; r++)
+            for (c=0; c<cols; c++)
+                if ((SUCCESS == mt->getEntry(mdat, r, c, &val))
+                    && (0 != (val % prime)))
+                    used[c] = 1;
+    }
+
+    for (nnz=c=0; c<cols; c++)
+        colidx[c] = used[c] ? nnz++ : -1;
+
+    if (nnz && (NULL == (colex = (exmo *) mallox(nnz * sizeof(exmo))))) {
+        freex(used); freex(colidx);
+        RETERR("out of memory");
+    }
+
+    if (nnz && (TCL_OK != Tcl_EnumUsedColumns(te, ip, used, cols, nnz, colex))) {
+        freex(used); freex(colidx); freex(colex);
+        return TCL_ERROR;
+    }
+
+    res = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(res);
+
+    for (r=0; (TCL_OK == rcode) && (r<rows); r++) {
+        void *pdat;
+        if (NULL == (pdat = PLcreate(stdpoly))) {
+            rcode = TCL_ERROR;
+            break;
+        }
+        if (NULL != m2) {
+            const m2word *rw = m2->data + r * m2->ipr;
+            int w, b;
+            for (w=0; nnz && (TCL_OK == rcode) && (w<m2->ipr); w++) {
+                m2word bits = rw[w];
+                for (b=0; bits; b++, bits >>= 1) {
+                    if (0 == (bits & 1)) continue;
+                    if ((c = w * BITSPERWORD + b) >= cols) break;
+                    if (SUCCESS != PLappendExmo(stdpoly, pdat, &(colex[colidx[c]]))) {
+                        rcode = TCL_ERROR;
+                        break;
+                    }
+                }
+            }
+        } else {
+            for (c=0; nnz && (c<cols); c++) {
+                if (colidx[c] < 0) continue;
+                if (SUCCESS != mt->getEntry(mdat, r, c, &val)) continue;
+                val = (val * scale) % prime;
+                if (val < 0) val += prime;
+                if (!val) continue;
+                colex[colidx[c]].coeff = val;
+                if (SUCCESS != PLappendExmo(stdpoly, pdat, &(colex[colidx[c]]))) {
+                    rcode = TCL_ERROR;
+                    break;
+                }
+            }
+        }
+        Tcl_ListObjAppendElement(ip, res, Tcl_NewPolyObj(stdpoly, pdat));
+    }
+
+    freex(used); freex(colidx);
+    if (NULL != colex) freex(colex);
+
+    if (TCL_OK == rcode)
+        Tcl_SetObjResult(ip, res);
+    Tcl_DecrRefCount(res);
+
+    if (TCL_OK != rcode)
+        RETERR("internal error in Tcl_EnumDecodeMatrixCmd");
+
+    return TCL_OK;
+}
+
 int Tcl_EnumEncodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
     tclEnum *te = (tclEnum *) cd;
     vectorType *vt; void *vdat;
     polyType   *pt; void *pdat;
-    int edim, pdim, idx, sqn, prime;
-    exmo ex;
+    int edim, pdim, idx, prime, owned;
+    seqint sqn, *seq;
+    exmo *dat;
 
     if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
 
@@ -615,43 +1163,115 @@ int Tcl_EnumEncodeCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
     pt   = polyTypeFromTclObj(obj);
     pdat = polyFromTclObj(obj);
 
-    edim = DimensionFromEnum(te->enm);
-    pdim = PLgetNumsum(pt, pdat);
+    if (TCL_OK != Tcl_EnumMatrixDim(te, ip, &edim)) return TCL_ERROR;
 
     vt = stdvector;
     if (NULL == (vdat = vt->createVector(edim)))
         RETERR("out of memory");
 
-    for (idx=0; idx<pdim; idx++) {
-        if (SUCCESS != PLgetExmo(pt, pdat, &ex, idx)) {
-            vt->destroyVector(vdat);
-            RETERR("internal error in Tcl_EnumEncodeCmd: PLgetExmo failed");
-        }
+    if (TCL_OK != Tcl_EnumPolySeqnos(te, ip, pt, pdat,
+                                     &dat, &seq, &pdim, &owned)) {
+        vt->destroyVector(vdat);
+        return TCL_ERROR;
+    }
 
-        sqn = SeqnoFromEnum(te->enm, &ex);
+#define FREESEQNOS { if (owned) freex(dat); freex(seq); }
+
+    for (idx=0; idx<pdim; idx++) {
+        sqn = seq[idx];
 
         if ((sqn<0) || (sqn>=edim)) {
             Tcl_Obj *aux;
             char err[200];
             vt->destroyVector(vdat);
-            aux = Tcl_NewExmoCopyObj(&ex);
-            sprintf(err,"could not find {%s} in basis (found seqno = %d)",
-                    Tcl_GetString(aux), sqn);
+            aux = Tcl_NewExmoCopyObj(&(dat[idx]));
+            sprintf(err,"could not find {%s} in basis (found seqno = %lld)",
+                    Tcl_GetString(aux), (long long) sqn);
             DECREFCNT(aux);
+            FREESEQNOS;
             RETERR(err);
         }
 
-        if (SUCCESS != vt->setEntry(vdat, sqn, ex.coeff % prime)) {
+        if (SUCCESS != vt->setEntry(vdat, (int) sqn, dat[idx].coeff % prime)) {
             vt->destroyVector(vdat);
+            FREESEQNOS;
             RETERR("internal error in Tcl_EnumEncodeCmd: vt->setEntry failed");
         }
     }
 
+    FREESEQNOS;
+
     Tcl_SetObjResult(ip, Tcl_NewVectorObj(vt, vdat));
 
     return TCL_OK;
 }
 
+int Tcl_EnumEncodeListCmd(ClientData cd, Tcl_Interp *ip, Tcl_Obj *obj) {
+    tclEnum *te = (tclEnum *) cd;
+    matrixType *mt; void *mdat;
+    int edim, pdim, idx, row, rows, prime, owned;
+    seqint *seq;
+    exmo *dat;
+    Tcl_Obj **pols;
+
+    if (TCL_OK != Tcl_ListObjGetElements(ip, obj, &rows, &pols))
+        return TCL_ERROR;
+
+    for (row=0; row<rows; row++)
+        if (TCL_OK != Tcl_ConvertToPoly(ip, pols[row]))
+            return TCL_ERROR;
+
+    if (TCL_OK != Tcl_EnumSetValues(cd, ip)) return TCL_ERROR;
+
+    prime = te->enm->pi->prime;
+    if (TCL_OK != Tcl_EnumMatrixDim(te, ip, &edim)) return TCL_ERROR;
+
+    mt = (2 == prime) ? stdmatrix2 : stdmatrix;
+    if (NULL == (mdat = mt->createMatrix(rows, edim)))
+        RETERR("out of memory");
+
+    for (row=0; row<rows; row++) {
+        if (TCL_OK != Tcl_EnumPolySeqnos(te, ip, polyTypeFromTclObj(pols[row]),
+                                         polyFromTclObj(pols[row]),
+                                         &dat, &seq, &pdim, &owned)) {
+            mt->destroyMatrix(mdat);
+            return TCL_ERROR;
+        }
+
+        for (idx=0; idx<pdim; idx++) {
+            seqint sqn = seq[idx];
+            int val;
+
+            if ((sqn<0) || (sqn>=edim)) {
+                Tcl_Obj *aux;
+                char err[200];
+                mt->destroyMatrix(mdat);
+                aux = Tcl_NewExmoCopyObj(&(dat[idx]));
+                sprintf(err,"could not find {%s} in basis (found seqno = %lld)",
+                        Tcl_GetString(aux), (long long) sqn);
+                DECREFCNT(aux);
+                FREESEQNOS;
+                RETERR(err);
+            }
+
+            val = dat[idx].coeff % prime;
+            if (val < 0) val += prime;
+
+            if (SUCCESS != mt->setEntry(mdat, row, (int) sqn, val)) {
+                mt->destroyMatrix(mdat);
+                FREESEQNOS;
+                RETERR("internal error in Tcl_EnumEncodeListCmd: setEntry failed");
+            }
+        }
+
+        FREESEQNOS;
+    }
+
+    Tcl_SetObjResult(ip, Tcl_NewMatrixObj(mt, mdat));
+
+    return TCL_OK;
+}
+
 #if USEOPENCL
 typedef struct {
     stcl_context *ctx;
@@ -743,11 +1363,15 @@ int STcl_EnumBasis(Tcl_Interp *ip, tclEnum *te, int objc, Tcl_Obj * const objv[]
 int STcl_EnumMap(Tcl_Interp *ip, tclEnum *te, int objc, Tcl_Obj * const objv[]) {
     stcl_context *ctx;
     if(TCL_OK != STcl_GetContext(ip, &ctx)) return TCL_ERROR;
-    int totdim = DimensionFromEnum(te->enm);
+    seqint totdim = DimensionFromEnum(te->enm);
     if(totdim<0) {
         Tcl_SetResult(ip, "internal error in DimensionFromEnum", TCL_STATIC);
         return TCL_ERROR;
     }
+    if(!SEQINTFITS(totdim)) {
+        Tcl_SetResult(ip, "dimension too large for the OpenCL kernels", TCL_STATIC);
+        return TCL_ERROR;
+    }
     // DimensionFromEnum has initialised or updated the seqoff and seqtab tables
     int tl = te->cl.tablen = te->enm->tablen, *st, *st2;
     st = (int*) malloc(sizeof(int)*NALG*te->enm->tablen);
@@ -758,7 +1382,7 @@ int STcl_EnumMap(Tcl_Interp *ip, tclEnum *te, int objc, Tcl_Obj * const objv[])
     st2 = st;
     for(int k=0;k<NALG;k++)
         for(int j=0;j<tl;j++)
-            *st2++ = te->enm->seqtab[k][j];
+            *st2++ = (int) MIN(te->enm->seqtab[k][j], (seqint) INT_MAX);
     if(te->cl.seqtab) free(te->cl.seqtab);
     te->cl.seqtab = st;
     int gcnt = te->enm->efflen, maxid=-1;
@@ -779,7 +1403,7 @@ int STcl_EnumMap(Tcl_Interp *ip, tclEnum *te, int objc, Tcl_Obj * const objv[])
     }
     for(int k=0;k<gcnt;k++) {
         effgen *eg = &(te->enm->efflist[k]);
-        st[eg->id] = te->enm->seqoff[k];
+        st[eg->id] = (int) te->enm->seqoff[k];
     }
     if(te->cl.offsets) free(te->cl.offsets);
     te->cl.gencnt = gcnt;
@@ -851,21 +1475,32 @@ int STcl_EnumMap(Tcl_Interp *ip, tclEnum *te, int objc, Tcl_Obj * const objv[])
 }
 #endif
 
-typedef enum { CGET, CONFIGURE, BASIS, SEQNO, SEQNOMOT, DIMENSION, TEST,
-               SIGRESET, SIGNEXT, SIGLIST, DECODE, ENCODE, ENM_MAX, ENM_MIN,
-               CLMAP, CLBASIS } enumcmdcode;
-
-static const char *cmdNames[] = { "test", "cget", "configure", "min", "max",
-                                  "basis", "seqno", "motseqno", "dimension",
-                                  "sigreset", "signext", "siglist",
-                                  "decode", "encode",
+typedef enum { CGET, CONFIGURE, ADDGENS, BASIS, FOREACHBASIS, SEQNO, SEQNOMOT, SEQNOS,
+               ELEMENT, DIMENSION, DIMENSIONS, TEST,
+               SIGRESET, SIGNEXT, SIGLIST, SIGTABLE,
+               DECODE, DECODEMAT, ENCODE, ENCODELIST,
+               ENM_MAX, ENM_MIN, CLMAP, CLBASIS } enumcmdcode;
+
+/* "dim" keeps the abbreviation of "dimension" unambiguous */
+static const char *cmdNames[] = { "test", "cget", "configure", "addgens",
+                                  "min", "max",
+                                  "basis", "foreach-basis",
+                                  "seqno", "motseqno", "seqnos",
+                                  "element", "dim", "dimension", "dimensions",
+                                  "sigreset", "signext", "siglist", "sigtable",
+                                  "decode", "decode-matrix",
+                                  "encode", "encode-list",
                                   "clmap", "clbasis",
                                   (char *) NULL };
 
-static enumcmdcode cmdmap[] = { TEST, CGET, CONFIGURE, ENM_MIN, ENM_MAX,
-                                BASIS, SEQNO, SEQNOMOT, DIMENSION,
-                                SIGRESET, SIGNEXT, SIGLIST,
-                                DECODE, ENCODE,
+static enumcmdcode cmdmap[] = { TEST, CGET, CONFIGURE, ADDGENS,
+                                ENM_MIN, ENM_MAX,
+                                BASIS, FOREACHBASIS,
+                                SEQNO, SEQNOMOT, SEQNOS,
+                                ELEMENT, DIMENSION, DIMENSION, DIMENSIONS,
+                                SIGRESET, SIGNEXT, SIGLIST, SIGTABLE,
+                                DECODE, DECODEMAT,
+                                ENCODE, ENCODELIST,
                                 CLMAP, CLBASIS };
 
 static const char *degNames[] = { "idegree", "edegree", "hdegree", "generator", (char *) NULL };
@@ -900,18 +1535,51 @@ int Tcl_EnumWidgetCmd(ClientData cd, Tcl_Interp *ip,
         case CONFIGURE:
             return Tcl_EnumConfigureCmd(cd, ip, objc-2, objv+2);
 
+        case ADDGENS:
+            if (objc != 3) {
+                Tcl_WrongNumArgs(ip, 2, objv, "genlist");
+                return TCL_ERROR;
+            }
+
+            return Tcl_EnumAddgensCmd(cd, ip, objv[2]);
+
         case BASIS:
             return Tcl_EnumBasisCmd(cd, ip, objc, objv);
 
+        case FOREACHBASIS:
+            return Tcl_EnumForeachBasisCmd(cd, ip, objc, objv);
+
         case SEQNO:
 	        return Tcl_EnumSeqnoCmd(cd, ip, 0, objc, objv);
 
         case SEQNOMOT:
 	        return Tcl_EnumSeqnoCmd(cd, ip, 1, objc, objv);
 
+        case SEQNOS:
+            if (objc != 3) {
+                Tcl_WrongNumArgs(ip, 2, objv, "polynomial");
+                return TCL_ERROR;
+            }
+
+            if (TCL_OK != Tcl_ConvertToPoly(ip, objv[2]))
+                return TCL_ERROR;
+
+            return Tcl_EnumSeqnosCmd(cd, ip, objv[2]);
+
+        case ELEMENT:
+            if (objc != 3) {
+                Tcl_WrongNumArgs(ip, 2, objv, "seqno");
+                return TCL_ERROR;
+            }
+
+            return Tcl_EnumElementCmd(cd, ip, objv[2]);
+
         case DIMENSION:
             return Tcl_EnumDimensionCmd(cd, ip, objc, objv);
 
+        case DIMENSIONS:
+            return Tcl_EnumDimensionsCmd(cd, ip, objc, objv);
+
         case ENM_MIN:
         case ENM_MAX:
             if (objc != 3) {
@@ -961,6 +1629,9 @@ int Tcl_EnumWidgetCmd(ClientData cd, Tcl_Interp *ip,
         case SIGLIST:
             return Tcl_EnumSiglistCmd(cd, ip, objc, objv);
 
+        case SIGTABLE:
+            return Tcl_EnumSigtableCmd(cd, ip, objc, objv);
+
         case DECODE:
             if ((objc < 3) || (objc > 4)) {
                 Tcl_WrongNumArgs(ip, 2, objv, "vector ?scale?");
@@ -978,6 +1649,23 @@ int Tcl_EnumWidgetCmd(ClientData cd, Tcl_Interp *ip,
 
             return Tcl_EnumDecodeCmd(cd, ip, objv[2], scale);
 
+        case DECODEMAT:
+            if ((objc < 3) || (objc > 4)) {
+                Tcl_WrongNumArgs(ip, 2, objv, "matrix ?scale?");
+                return TCL_ERROR;
+            }
+
+            if (TCL_OK != Tcl_ConvertToMatrix(ip, objv[2]))
+                return TCL_ERROR;
+
+            scale = 1;
+
+            if (objc==4)
+                if (TCL_OK != Tcl_GetIntFromObj(ip, objv[3], &scale))
+                    return TCL_ERROR;
+
+            return Tcl_EnumDecodeMatrixCmd(cd, ip, objv[2], scale);
+
         case ENCODE:
 
             if (objc!=3) {
@@ -990,6 +1678,15 @@ int Tcl_EnumWidgetCmd(ClientData cd, Tcl_Interp *ip,
 
             return Tcl_EnumEncodeCmd(cd, ip, objv[2]);
 
+        case ENCODELIST:
+
+            if (objc!=3) {
+                Tcl_WrongNumArgs(ip, 2, objv, "polynomials");
+                return TCL_ERROR;
+            }
+
+            return Tcl_EnumEncodeListCmd(cd, ip, objv[2]);
+
         case CLMAP:
         {
 #if USEOPENCL
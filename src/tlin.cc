@@ -16,6 +16,7 @@
 #include "steenrod.h"
 #include <string.h>
 #include "setresult.h"
+#include "sparse.h"
 
 #if USEOPENCL
 #include "linwrp.h"
@@ -104,6 +105,42 @@ void VectorFreeInternalRepProc(Tcl_Obj *obj) {
     DECVECCNT;
 }
 
+/* decode the compact form "@vector <length> <data>" */
+static void *VectorFromCompact(Tcl_Interp *ip, Tcl_Obj **objv) {
+    int len, dlen, i;
+    unsigned char *data;
+    const unsigned char *wrk, *end;
+    void *vct;
+
+    if (TCL_OK != Tcl_GetIntFromObj(ip, objv[1], &len))
+        return NULL;
+    if (TCL_OK != compactStringData(ip, objv[2], &data, &dlen))
+        return NULL;
+    if (NULL == (vct = (stdvector->createVector)(len))) {
+        freex(data);
+        Tcl_SetResult(ip, "out of memory", TCL_STATIC);
+        return NULL;
+    }
+
+    wrk = data;
+    end = data + dlen;
+    for (i = 0; i < len; i++) {
+        long long val;
+        if (SUCCESS != binDecodeInt(&wrk, end, &val) ||
+            SUCCESS != (stdvector->setEntry)(vct, i, (int)val))
+            break;
+    }
+    freex(data);
+
+    if (i < len || wrk != end) {
+        (stdvector->destroyVector)(vct);
+        Tcl_SetResult(ip, "malformed compact vector", TCL_STATIC);
+        return NULL;
+    }
+
+    return vct;
+}
+
 int VectorSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     int objc, i, val;
     Tcl_Obj **objv;
@@ -112,6 +149,17 @@ int VectorSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     if (TCL_OK != Tcl_ListObjGetElements(ip, objPtr, &objc, &objv))
         return TCL_ERROR;
 
+    if (3 == objc && isCompactTag(objv[0], "@vector")) {
+        if (NULL == (vct = VectorFromCompact(ip, objv)))
+            return TCL_ERROR;
+        TRYFREEOLDREP(objPtr);
+        PTR1(objPtr) = stdvector;
+        PTR2(objPtr) = vct;
+        objPtr->typePtr = &tclVector;
+        INCVECCNT;
+        return TCL_OK;
+    }
+
     vct = (stdvector->createVector)(objc);
     if (NULL == vct) {
         Tcl_SetResult(ip, "out of memory in VectorSetFromAnyProc", TCL_STATIC);
@@ -141,32 +189,72 @@ int VectorSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     return TCL_OK;
 }
 
-Tcl_Obj *Tcl_NewListFromVector(Tcl_Obj *obj) {
-    int len, i;
+Tcl_Obj *Tcl_NewListFromVectorRange(Tcl_Obj *obj, int first, int num) {
+    int i;
     vectorType *vt = (vectorType *)PTR1(obj);
     Tcl_Obj **objv, *res;
 
-    len = (vt->getLength)(PTR2(obj));
-
-    if (NULL == (objv = (Tcl_Obj**)mallox(len * sizeof(Tcl_Obj *))))
+    if (NULL == (objv = (Tcl_Obj**)mallox(num * sizeof(Tcl_Obj *))))
         return NULL;
 
-    for (i = 0; i < len; i++) {
+    for (i = 0; i < num; i++) {
         int val;
-        if (SUCCESS != (vt->getEntry)(PTR2(obj), i, &val)) {
+        if (SUCCESS != (vt->getEntry)(PTR2(obj), first + i, &val)) {
             freex(objv);
             return NULL;
         }
         objv[i] = Tcl_NewIntObj(val);
     }
 
-    res = Tcl_NewListObj(len, objv);
+    res = Tcl_NewListObj(num, objv);
     freex(objv);
     return res;
 }
 
+Tcl_Obj *Tcl_NewListFromVector(Tcl_Obj *obj) {
+    vectorType *vt = (vectorType *)PTR1(obj);
+    return Tcl_NewListFromVectorRange(obj, 0, (vt->getLength)(PTR2(obj)));
+}
+
+/* compact string rep "@vector <length> <data>" for long vectors */
+static int VectorCompactString(Tcl_Obj *objPtr) {
+    vectorType *vt = (vectorType *)PTR1(objPtr);
+    int len = (vt->getLength)(PTR2(objPtr)), i, val;
+    size_t dlen = 0;
+    unsigned char *data;
+    char header[50];
+
+    if (!USECOMPACTSTRING(len))
+        return 0;
+
+    sprintf(header, "@vector %d", len);
+
+    /* every entry takes at least one byte */
+    if ((size_t) len > COMPACTSTRINGMAX) {
+        setCompactStringRep(objPtr, header, NULL, 0); /* panics */
+        return 1;
+    }
+
+    if (NULL == (data = (unsigned char *)mallox(10 * (size_t) len + 1)))
+        return 0;
+
+    for (i = 0; i < len; i++) {
+        long long v;
+        (vt->getEntry)(PTR2(objPtr), i, &val);
+        v = val;
+        dlen += binEncodeInts(data + dlen, &v, 1);
+    }
+
+    setCompactStringRep(objPtr, header, data, dlen);
+    freex(data);
+    return 1;
+}
+
 void VectorUpdateStringProc(Tcl_Obj *objPtr) {
-    Tcl_Obj *aux = Tcl_NewListFromVector(objPtr);
+    Tcl_Obj *aux;
+    if (VectorCompactString(objPtr))
+        return;
+    aux = Tcl_NewListFromVector(objPtr);
     copyStringRep(objPtr, aux);
     FREETCLOBJ(aux);
 }
@@ -242,6 +330,107 @@ void MatrixFreeInternalRepProc(Tcl_Obj *obj) {
         return TCL_ERROR;                                                      \
     }
 
+/* append the lowest nb bits of x to a little endian bit stream; acc
+ * holds the nacc < 8 bits that do not yet fill a byte */
+static void pack2Bits(unsigned char *out, size_t *pos, m2word *acc, int *nacc,
+                      m2word x, int nb) {
+    m2word lo, hi;
+    int tot = *nacc + nb, i;
+
+    if (nb < (int) BITSPERWORD)
+        x &= (((m2word) 1) << nb) - 1;
+
+    lo = *acc | (x << *nacc);
+    hi = *nacc ? (x >> (BITSPERWORD - *nacc)) : 0;
+
+    if (tot >= (int) BITSPERWORD) {
+        for (i = 0; i < (int) sizeof(m2word); i++, lo >>= 8)
+            out[(*pos)++] = (unsigned char) (lo & 0xff);
+        lo = hi;
+        tot -= BITSPERWORD;
+    }
+    for (; tot >= 8; tot -= 8, lo >>= 8)
+        out[(*pos)++] = (unsigned char) (lo & 0xff);
+
+    *acc = lo;
+    *nacc = tot;
+}
+
+/* read nb <= 64 bits at bit offset off of a little endian bit stream */
+static m2word unpack2Bits(const unsigned char *data, size_t off, int nb) {
+    const unsigned char *p = data + (off >> 3);
+    int got = 8 - (int) (off & 7);
+    m2word x = *p++ >> (off & 7);
+
+    for (; got < nb; got += 8)
+        x |= ((m2word) *p++) << got;
+
+    if (nb < (int) BITSPERWORD)
+        x &= (((m2word) 1) << nb) - 1;
+
+    return x;
+}
+
+/* decode the compact forms "@matrix <rows> <cols> <data>" and
+ * "@matrix2 <rows> <cols> <data>"; the latter holds a bit field */
+static int MatrixFromCompact(Tcl_Interp *ip, Tcl_Obj **objv,
+                             matrixType **mtp, void **matp) {
+    int rows, cols, dlen, i, j, ok = 1;
+    unsigned char *data;
+    const unsigned char *wrk, *end;
+    matrixType *mt;
+    void *mat;
+
+    mt = isCompactTag(objv[0], "@matrix2") ? stdmatrix2 : stdmatrix;
+
+    if (TCL_OK != Tcl_GetIntFromObj(ip, objv[1], &rows))
+        return TCL_ERROR;
+    if (TCL_OK != Tcl_GetIntFromObj(ip, objv[2], &cols))
+        return TCL_ERROR;
+    if (rows < 0 || cols < 0)
+        RETERR("malformed compact matrix");
+    if (TCL_OK != compactStringData(ip, objv[3], &data, &dlen))
+        return TCL_ERROR;
+    if (NULL == (mat = (mt->createMatrix)(rows, cols))) {
+        freex(data);
+        RETERR("out of memory");
+    }
+
+    wrk = data;
+    end = data + dlen;
+    if (stdmatrix2 == mt) {
+        mat2 *m2 = (mat2 *) mat;
+        size_t off = 0;
+        ok = ((size_t) dlen == (((size_t) rows * cols + 7) >> 3));
+        for (i = 0; ok && i < rows; i++) {
+            m2word *rw = m2->data + (size_t) i * m2->ipr;
+            for (j = 0; j < cols; j += BITSPERWORD) {
+                int nb = (cols - j < (int) BITSPERWORD) ? cols - j : BITSPERWORD;
+                rw[j / BITSPERWORD] = unpack2Bits(data, off, nb);
+                off += nb;
+            }
+        }
+    } else {
+        for (i = 0; ok && i < rows; i++)
+            for (j = 0; ok && j < cols; j++) {
+                long long val;
+                ok = (SUCCESS == binDecodeInt(&wrk, end, &val)) &&
+                     (SUCCESS == (mt->setEntry)(mat, i, j, (int)val));
+            }
+        ok = ok && (wrk == end);
+    }
+    freex(data);
+
+    if (!ok) {
+        (mt->destroyMatrix)(mat);
+        RETERR("malformed compact matrix");
+    }
+
+    *mtp = mt;
+    *matp = mat;
+    return TCL_OK;
+}
+
 int MatrixSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     int objc, objc2, rows, cols = 0, i, j, val;
     Tcl_Obj **objv, **objv2;
@@ -250,6 +439,19 @@ int MatrixSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     if (TCL_OK != Tcl_ListObjGetElements(ip, objPtr, &objc, &objv))
         return TCL_ERROR;
 
+    if (4 == objc && (isCompactTag(objv[0], "@matrix") ||
+                      isCompactTag(objv[0], "@matrix2"))) {
+        matrixType *mt;
+        if (TCL_OK != MatrixFromCompact(ip, objv, &mt, &mat))
+            return TCL_ERROR;
+        TRYFREEOLDREP(objPtr);
+        PTR1(objPtr) = mt;
+        PTR2(objPtr) = mat;
+        objPtr->typePtr = &tclMatrix;
+        INCMATCNT;
+        return TCL_OK;
+    }
+
     rows = objc;
 
     for (i = 0; i < objc; i++) {
@@ -295,14 +497,14 @@ int MatrixSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     return TCL_OK;
 }
 
-Tcl_Obj *Tcl_NewListFromMatrix(Tcl_Obj *obj) {
+Tcl_Obj *Tcl_NewListFromMatrixRows(Tcl_Obj *obj, int first, int num) {
     int rows, cols, i, j;
     matrixType *vt = (matrixType *)PTR1(obj);
     Tcl_Obj **objv, **objv2, *res;
 
     (vt->getDimensions)(PTR2(obj), &rows, &cols);
 
-    if (NULL == (objv = (Tcl_Obj**) mallox(rows * sizeof(Tcl_Obj *))))
+    if (NULL == (objv = (Tcl_Obj**) mallox(num * sizeof(Tcl_Obj *))))
         return NULL;
 
     if (NULL == (objv2 = (Tcl_Obj**) mallox(cols * sizeof(Tcl_Obj *)))) {
@@ -310,10 +512,10 @@ Tcl_Obj *Tcl_NewListFromMatrix(Tcl_Obj *obj) {
         return NULL;
     }
 
-    for (j = 0; j < rows; j++) {
+    for (j = 0; j < num; j++) {
         for (i = 0; i < cols; i++) {
             int val;
-            if (SUCCESS != (vt->getEntry)(PTR2(obj), j, i, &val)) {
+            if (SUCCESS != (vt->getEntry)(PTR2(obj), first + j, i, &val)) {
                 freex(objv);
                 return NULL;
             }
@@ -323,14 +525,99 @@ Tcl_Obj *Tcl_NewListFromMatrix(Tcl_Obj *obj) {
         objv[j] = Tcl_NewListObj(cols, objv2);
     }
 
-    res = Tcl_NewListObj(rows, objv);
+    res = Tcl_NewListObj(num, objv);
     freex(objv);
     freex(objv2);
     return res;
 }
 
+Tcl_Obj *Tcl_NewListFromMatrix(Tcl_Obj *obj) {
+    int rows, cols;
+    matrixType *vt = (matrixType *)PTR1(obj);
+    (vt->getDimensions)(PTR2(obj), &rows, &cols);
+    return Tcl_NewListFromMatrixRows(obj, 0, rows);
+}
+
+/* compact string rep for large matrices, see MatrixFromCompact */
+static int MatrixCompactString(Tcl_Obj *objPtr) {
+    matrixType *mt = (matrixType *)PTR1(objPtr);
+    void *mat = PTR2(objPtr);
+    int rows, cols, i, j, val;
+    size_t dlen = 0, dmax;
+    unsigned char *data;
+    char header[80];
+
+    (mt->getDimensions)(mat, &rows, &cols);
+
+    if (!USECOMPACTSTRING((long long)rows * cols))
+        return 0;
+
+    if (stdmatrix2 == mt) {
+        mat2 *m2 = (mat2 *) mat;
+        m2word acc = 0;
+        int nacc = 0;
+
+        sprintf(header, "@matrix2 %d %d", rows, cols);
+        dmax = ((size_t) rows * cols + 7) >> 3;
+        if (dmax > COMPACTSTRINGMAX) {
+            setCompactStringRep(objPtr, header, NULL, 0); /* panics */
+            return 1;
+        }
+        /* pack2Bits writes whole words, so leave room for one more */
+        if (NULL == (data = (unsigned char *)callox(dmax + sizeof(m2word), 1)))
+            return 0;
+        for (i = 0; i < rows; i++) {
+            const m2word *rw = m2->data + (size_t) i * m2->ipr;
+            for (j = 0; j < cols; j += BITSPERWORD)
+                pack2Bits(data, &dlen, &acc, &nacc, rw[j / BITSPERWORD],
+                          (cols - j < (int) BITSPERWORD) ? cols - j : BITSPERWORD);
+        }
+        if (nacc)
+            data[dlen++] = (unsigned char) acc;
+    } else {
+        sprintf(header, "@matrix %d %d", rows, cols);
+        /* every entry takes at least one byte */
+        if ((size_t) rows * cols > COMPACTSTRINGMAX) {
+            setCompactStringRep(objPtr, header, NULL, 0); /* panics */
+            return 1;
+        }
+        dmax = (size_t) rows * cols + 10 * (size_t) cols;
+        if (NULL == (data = (unsigned char *)mallox(dmax)))
+            return 0;
+        for (i = 0; i < rows; i++) {
+            if (dlen > COMPACTSTRINGMAX) {
+                freex(data);
+                setCompactStringRep(objPtr, header, NULL, 0); /* panics */
+                return 1;
+            }
+            if (dlen + 10 * (size_t) cols > dmax) {
+                unsigned char *aux;
+                dmax += dmax / 2 + 10 * (size_t) cols;
+                if (NULL == (aux = (unsigned char *)reallox(data, dmax))) {
+                    freex(data);
+                    return 0;
+                }
+                data = aux;
+            }
+            for (j = 0; j < cols; j++) {
+                long long v;
+                (mt->getEntry)(mat, i, j, &val);
+                v = val;
+                dlen += binEncodeInts(data + dlen, &v, 1);
+            }
+        }
+    }
+
+    setCompactStringRep(objPtr, header, data, dlen);
+    freex(data);
+    return 1;
+}
+
 void MatrixUpdateStringProc(Tcl_Obj *objPtr) {
-    Tcl_Obj *aux = Tcl_NewListFromMatrix(objPtr);
+    Tcl_Obj *aux;
+    if (MatrixCompactString(objPtr))
+        return;
+    aux = Tcl_NewListFromMatrix(objPtr);
     copyStringRep(objPtr, aux);
     FREETCLOBJ(aux);
 }
@@ -367,8 +654,9 @@ Tcl_Obj *Tcl_LiftCmd(primeInfo *pi, Tcl_Obj *inp, Tcl_Obj *lft, Tcl_Obj *bas,
                      Tcl_Interp *ip, const char *progvar, int pmsk,
                      int *interruptVar) {
     matrixType *mt = (matrixType *) PTR1(inp), *mt2 = (matrixType *) PTR1(lft);
+    matrixType *bt = (NULL != bas) ? (matrixType *) PTR1(bas) : mt;
     int krows, kcols, irows, icols;
-    void *rdat;
+    void *rdat, *basdat = (NULL != bas) ? PTR2(bas) : NULL, *ownbas = NULL;
     progressInfo pro;
 
     if (NULL == bas) {
@@ -383,7 +671,21 @@ Tcl_Obj *Tcl_LiftCmd(primeInfo *pi, Tcl_Obj *inp, Tcl_Obj *lft, Tcl_Obj *bas,
     if ((NULL == (mt->liftFunc)))
         FAILASSERT("matrix type has no lift func");
 
-    if ((mt != mt2)) {
+    /* lft is ours, so it is converted to the type of inp in place; a
+     * sparse inp also needs a sparse basis, for which we use a private
+     * copy since bas may be shared */
+    if ((mt2 != mt) && ((sparsematrix == mt) || (sparsematrix == mt2))) {
+        void *newlft = (sparsematrix == mt)
+            ? createSparseMatrixCopy(mt2, PTR2(lft))
+            : createMatrixCopy(mt, mt2, PTR2(lft));
+        if (NULL == newlft)
+            FAILASSERT("out of memory");
+        mt2->destroyMatrix(PTR2(lft));
+        PTR1(lft) = mt2 = mt;
+        PTR2(lft) = newlft;
+    }
+
+    if ((mt != mt2) || ((bt != mt) && (sparsematrix != mt))) {
         FAILASSERT("matrix types differ");
     }
 
@@ -410,12 +712,20 @@ Tcl_Obj *Tcl_LiftCmd(primeInfo *pi, Tcl_Obj *inp, Tcl_Obj *lft, Tcl_Obj *bas,
     pro.pmsk = pmsk;
     pro.interruptVar = interruptVar;
 
+    if (bt != mt) {
+        if (NULL == (basdat = ownbas = createSparseMatrixCopy(bt, basdat)))
+            FAILASSERT("out of memory");
+    }
+
     Tcl_InvalidateStringRep(lft);
     if (NULL == bas)
         Tcl_InvalidateStringRep(inp);
-    rdat = (mt->liftFunc)(pi, PTR2(inp), PTR2(lft), bas ? PTR2(bas) : NULL,
+    rdat = (mt->liftFunc)(pi, PTR2(inp), PTR2(lft), basdat,
                           (NULL != progvar) ? &pro : NULL);
 
+    if (NULL != ownbas)
+        sparsematrix->destroyMatrix(ownbas);
+
     if (NULL == rdat)
         return NULL;
 
@@ -620,7 +930,25 @@ int ExtractColsCmd(Tcl_Interp *ip, Tcl_Obj *mat, int *ind, int num) {
     oro = ir;
     oc = num;
 
+    for (i = 0; i < num; i++) {
+        if (ind[i] < 0)
+            RETERR("negative index");
+        if (ind[i] >= ic && ir > 0)
+            RETERR("index too big");
+    }
+
     mt2 = mt1;
+
+    if ((NULL != mt1->extractCols) && (ir > 0)) {
+        mdat2 = mt1->extractCols(mdat1, ind, num);
+
+        if (NULL == mdat2)
+            RETERR("out of memory");
+
+        Tcl_SetObjResult(ip, Tcl_NewMatrixObj(mt2, mdat2));
+        return TCL_OK;
+    }
+
     mdat2 = mt2->createMatrix(oro, oc);
 
     if (NULL == mdat2)
@@ -628,15 +956,6 @@ int ExtractColsCmd(Tcl_Interp *ip, Tcl_Obj *mat, int *ind, int num) {
 
     for (i = 0; i < num; i++) {
         int idx = ind[i];
-        if (idx < 0) {
-            Tcl_SetResult(ip, "negative index", TCL_STATIC);
-            mt2->destroyMatrix(mdat2);
-            return TCL_ERROR;
-        } else if (idx >= ic && ir > 0) {
-            Tcl_SetResult(ip, "index too big", TCL_STATIC);
-            mt2->destroyMatrix(mdat2);
-            return TCL_ERROR;
-        }
         for (j = 0; j < ir; j++) {
             int val;
             mt1->getEntry(mdat1, j, idx, &val);
@@ -648,6 +967,34 @@ int ExtractColsCmd(Tcl_Interp *ip, Tcl_Obj *mat, int *ind, int num) {
     return TCL_OK;
 }
 
+int TransposeCmd(Tcl_Interp *ip, Tcl_Obj *mat) {
+    matrixType *mt;
+    void *mdat, *res;
+    int i, j, rows, cols;
+
+    mt = matrixTypeFromTclObj(mat);
+    mdat = matrixFromTclObj(mat);
+
+    mt->getDimensions(mdat, &rows, &cols);
+
+    if (NULL != mt->transpose) {
+        if (NULL == (res = mt->transpose(mdat)))
+            RETERR("out of memory");
+    } else {
+        if (NULL == (res = mt->createMatrix(cols, rows)))
+            RETERR("out of memory");
+        for (i = 0; i < rows; i++)
+            for (j = 0; j < cols; j++) {
+                int val;
+                mt->getEntry(mdat, i, j, &val);
+                mt->setEntry(res, j, i, val);
+            }
+    }
+
+    Tcl_SetObjResult(ip, Tcl_NewMatrixObj(mt, res));
+    return TCL_OK;
+}
+
 int ExtractRowsCmd(Tcl_Interp *ip, Tcl_Obj *mat, int *ind, int num) {
     matrixType *mt1, *mt2;
     void *mdat1, *mdat2;
@@ -1071,6 +1418,24 @@ int Tcl_Convert2Cmd(Tcl_Interp *ip, Tcl_Obj *inmat) {
     return TCL_OK;
 }
 
+int Tcl_ConvertSparseCmd(Tcl_Interp *ip, Tcl_Obj *inmat) {
+    void *res;
+
+    if (TCL_OK != Tcl_ConvertToMatrix(ip, inmat))
+        return TCL_ERROR;
+
+    res = createSparseMatrixCopy(matrixTypeFromTclObj(inmat),
+                                 matrixFromTclObj(inmat));
+
+    if (NULL == res) {
+        Tcl_SetResult(ip, "Out of memory", TCL_STATIC);
+        return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(ip, Tcl_NewMatrixObj(sparsematrix, res));
+    return TCL_OK;
+}
+
 int Tcl_MultMatrixCmd(Tcl_Interp *ip, primeInfo *pi, Tcl_Obj *f1, Tcl_Obj *f2) {
 
     matrixType *mt1, *mt2;
@@ -1098,6 +1463,26 @@ int Tcl_MultMatrixCmd(Tcl_Interp *ip, primeInfo *pi, Tcl_Obj *f1, Tcl_Obj *f2) {
 
     mres = mt1->createMatrix(rows, cols);
 
+    if (NULL == mres) {
+        Tcl_SetResult(ip, "Out of memory", TCL_STATIC);
+        return TCL_ERROR;
+    }
+
+    /* use the native product if both factors have the same type */
+    if ((mt1 == mt2) && (NULL != mt1->multFunc)) {
+        int rc = mt1->multFunc(mres, mdat1, mdat2, p);
+        if (SUCCESS == rc) {
+            Tcl_SetObjResult(ip, Tcl_NewMatrixObj(mt1, mres));
+            return TCL_OK;
+        }
+        if (FAILMEM == rc) {
+            mt1->destroyMatrix(mres);
+            Tcl_SetResult(ip, "Out of memory", TCL_STATIC);
+            return TCL_ERROR;
+        }
+        mt1->clearMatrix(mres);
+    }
+
     for (i = 0; i < rows; i++) {
         for (j = 0; j < cols; j++) {
             int aux = 0;
@@ -1129,8 +1514,8 @@ int MatrixCLCreatePostProc(ClientData data[], Tcl_Interp *ip, int result) {
     if (returnmatrix && TCL_OK == result)
         do {
             result = TCL_ERROR;
-            size_t dsz = m2->ipr * m2->rows * sizeof(int);
-            m2->data = (int*) malloc(dsz ? dsz : 1);
+            size_t dsz = m2->ipr * m2->rows * sizeof(m2word);
+            m2->data = (m2word*) malloc(dsz ? dsz : 1);
             if (NULL == m2->data) {
                 Tcl_SetResult(ip, "out of memory", TCL_STATIC);
                 break;
@@ -1176,7 +1561,7 @@ int MatrixCLMapPostProc(ClientData data[], Tcl_Interp *ip, int result) {
         do {
             result = TCL_ERROR;
             mat2 *m2 = (mat2 *) matrixFromTclObj(matobj);
-            size_t dsz = m2->ipr * m2->rows * sizeof(int);
+            size_t dsz = m2->ipr * m2->rows * sizeof(m2word);
             int rc;
             cl_command_queue q = GetOrCreateCommandQueue(ip, ctx, 0);
             if (NULL == q)
@@ -1228,19 +1613,24 @@ typedef enum {
     CLMAP,
     CLALLOC,
     CLCREATE,
-    CLENQREAD
+    CLENQREAD,
+    TRANSPOSE,
+    SPARSE,
+    RANDOM2
 } matcmdcode;
 
 static const char *mCmdNames[] = {
     "orthonormalize", "lift",   "liftvar", "quotient", "extract",
     "dimensions",     "create", "addto",   "iszero",   "test",
     "encode64",       "decode", "type",    "convert2", "multiply",
-    "unit",           "concat", "clmap",   "clalloc", "clcreate", "clenqread", (char *)NULL};
+    "unit",           "concat", "clmap",   "clalloc", "clcreate", "clenqread",
+    "transpose",      "sparse", "random2", (char *)NULL};
 
 static matcmdcode mCmdmap[] = {ORTHO,    LIFT,   LIFTV, QUOT,     EXTRACT,
                                DIMS,     CREATE, ADDTO, ISZERO,   TEST,
                                ENCODE64, DECODE, TYPE,  CONVERT2, MULT,
-                               UNIT,     CONCAT, CLMAP, CLALLOC, CLCREATE, CLENQREAD};
+                               UNIT,     CONCAT, CLMAP, CLALLOC, CLCREATE, CLENQREAD,
+                               TRANSPOSE, SPARSE, RANDOM2};
 
 int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
                       Tcl_Obj *const objv[]) {
@@ -1508,6 +1898,50 @@ int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
 
         return Tcl_MultMatrixCmd(ip, pi, objv[3], objv[4]);
     }
+    case TRANSPOSE:
+    {
+        EXPECTARGS(2, 1, 1, "<matrix>");
+
+        if (TCL_OK != Tcl_ConvertToMatrix(ip, objv[2]))
+            return TCL_ERROR;
+
+        return TransposeCmd(ip, objv[2]);
+    }
+    case SPARSE:
+    {
+        EXPECTARGS(2, 1, 1, "<matrix>");
+
+        return Tcl_ConvertSparseCmd(ip, objv[2]);
+    }
+    case RANDOM2:
+    {
+        int rounds = 27;
+        Tcl_WideInt seed = 4711;
+
+        EXPECTARGS(2, 2, 4, "<rows> <columns> ?<rounds>? ?<seed>?");
+
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[2], &rows))
+            return TCL_ERROR;
+
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[3], &cols))
+            return TCL_ERROR;
+
+        if ((objc > 4) && (TCL_OK != Tcl_GetIntFromObj(ip, objv[4], &rounds)))
+            return TCL_ERROR;
+
+        if ((objc > 5) && (TCL_OK != Tcl_GetWideIntFromObj(ip, objv[5], &seed)))
+            return TCL_ERROR;
+
+        if ((rows < 0) || (cols < 0))
+            RETERR("dimensions must not be negative");
+
+        if (NULL == (mdat = stdRandomMatrix2(rows, cols, rounds,
+                                             (unsigned int) seed)))
+            RETERR("out of memory");
+
+        Tcl_SetObjResult(ip, Tcl_NewMatrixObj(stdmatrix2, mdat));
+        return TCL_OK;
+    }
     case DIMS:
     {
         EXPECTARGS(2, 1, 1, "<matrix>");
@@ -1706,7 +2140,7 @@ int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
         m2->cols = ncols;
         m2->ipr = IPROCO(ncols);
         int rc;
-        size_t dsz = sizeof(int) * m2->ipr * m2->rows;
+        size_t dsz = sizeof(m2word) * m2->ipr * m2->rows;
         cl_mem clm = clCreateBuffer(ctx->ctx,
                                     CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR |
                                         CL_MEM_HOST_READ_ONLY,
@@ -1727,7 +2161,7 @@ int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
         Tcl_Obj *dims[3];
         dims[0] = Tcl_NewIntObj(m2->rows);
         dims[1] = Tcl_NewIntObj(m2->cols);
-        dims[2] = Tcl_NewIntObj(m2->ipr * sizeof(int)/4);
+        dims[2] = Tcl_NewIntObj(m2->ipr * sizeof(m2word)/4);
         Tcl_ObjSetVar2(ip, objv[5], NULL, Tcl_NewListObj(3, dims), 0);
         clRetainMemObject(clm);
         Tcl_NRAddCallback(ip, MatrixCLCreatePostProc, m2, clm, ctx, (ClientData) (intptr_t) (mCmdmap[index] == CLCREATE ? 1 : 0));
@@ -1767,10 +2201,10 @@ int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
         Tcl_Obj *dims[3];
         dims[0] = Tcl_NewIntObj(m2->rows);
         dims[1] = Tcl_NewIntObj(m2->cols);
-        dims[2] = Tcl_NewIntObj(m2->ipr * sizeof(int)/4);
+        dims[2] = Tcl_NewIntObj(m2->ipr * sizeof(m2word)/4);
         Tcl_ObjSetVar2(ip, objv[5], NULL, Tcl_NewListObj(3, dims), 0);
         int rc;
-        size_t dsz = sizeof(int) * m2->ipr * m2->rows;
+        size_t dsz = sizeof(m2word) * m2->ipr * m2->rows;
         cl_mem clm = clCreateBuffer(ctx->ctx, flags, dsz, m2->data, &rc);
         if (rc != CL_SUCCESS) {
             SetCLErrorCode(ip, rc);
@@ -1822,14 +2256,14 @@ int MatrixNRECombiCmd(ClientData cd, Tcl_Interp *ip, int objc,
             Tcl_SetResult(ip, "out of memory", TCL_STATIC);
             return TCL_ERROR;
         }
-        if (NULL == (m2->data = (int*) malloc(dsz ? dsz : 1))) {
+        if (NULL == (m2->data = (m2word*) malloc(dsz ? dsz : 1))) {
             free(m2);
             Tcl_SetResult(ip, "out of memory", TCL_STATIC);
             return TCL_ERROR;
         }
         m2->rows = nrows;
         m2->cols = ncols;
-        m2->ipr = ipr;
+        m2->ipr = ipr * 4 / sizeof(m2word); /* matdims count 32 bit words */
         cl_int rc;
         int numwait = 0;
         cl_event *evtlist = NULL;
@@ -33,6 +33,11 @@ void       *matrixFromTclObj(Tcl_Obj *obj);
 Tcl_Obj *Tcl_NewMatrixObj(matrixType *tp, void *data);
 Tcl_Obj *Tcl_NewVectorObj(vectorType *tp, void *data);
 
+/* lists of the entries first, ..., first + num - 1 of a vector,
+ * resp. of the rows first, ..., first + num - 1 of a matrix */
+Tcl_Obj *Tcl_NewListFromVectorRange(Tcl_Obj *obj, int first, int num);
+Tcl_Obj *Tcl_NewListFromMatrixRows(Tcl_Obj *obj, int first, int num);
+
 /* ids of the types that we register */
 #define TP_VECTOR 13
 #define TP_MATRIX 16
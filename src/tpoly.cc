@@ -82,7 +82,7 @@ Tcl_Obj *Tcl_NewExmoObj(exmo *ex) {
 }
 
 Tcl_Obj *Tcl_NewExmoCopyObj(exmo *ex) {
-    exmo *x = (exmo*) mallox(sizeof(exmo));
+    exmo *x = arenaAllocExmo();
     TCLMEMASSERT(x);
     copyExmo(x,ex);
     return Tcl_NewExmoObj(x);
@@ -90,11 +90,11 @@ Tcl_Obj *Tcl_NewExmoCopyObj(exmo *ex) {
 
 /* free internal representation */
 void ExmoFreeInternalRepProc(Tcl_Obj *obj) {
-    freex((polyType*)PTR1(obj));
+    arenaFreeExmo((exmo *) PTR1(obj));
     DECMONCNT;
 }
 
-#define FREEEANDRETERR { freex((char *) e); return TCL_ERROR; }
+#define FREEEANDRETERR { arenaFreeExmo(e); return TCL_ERROR; }
 
 /* try to turn objPtr into an Exmo */
 int ExmoSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
@@ -110,7 +110,7 @@ int ExmoSetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
         return TCL_ERROR;
     if (4 != objc)
         RETERR("malformed monomial: wrong number of entries");
-    if (NULL == (e = (exmo *) mallox(sizeof(exmo))))
+    if (NULL == (e = arenaAllocExmo()))
         RETERR("out of memory");
     if (TCL_OK != Tcl_GetIntFromObj(ip,objv[0],&aux))
         FREEEANDRETERR;
@@ -167,7 +167,7 @@ void ExmoUpdateStringProc(Tcl_Obj *objPtr) {
 
 /* create copy */
 void ExmoDupInternalRepProc(Tcl_Obj *srcPtr, Tcl_Obj *dupPtr) {
-    exmo *ans = (exmo *) mallox(sizeof(exmo));
+    exmo *ans = arenaAllocExmo();
     TCLMEMASSERT(ans);
     memcpy(ans, PTR1(srcPtr), sizeof(exmo));
     PTR1(dupPtr) = ans;
@@ -228,19 +228,24 @@ Tcl_Obj *Tcl_NewPolyObj(polyType *tp, void *data) {
     return res;
 }
 
-Tcl_Obj *Tcl_NewListFromPoly(Tcl_Obj *obj) {
-    int i, len = PLgetNumsum((polyType *) PTR1(obj),PTR2(obj));
-    Tcl_Obj *res, **arr = (Tcl_Obj **) ckalloc(len * sizeof(Tcl_Obj *));
+Tcl_Obj *Tcl_NewListFromPolyRange(Tcl_Obj *obj, int first, int num) {
+    int i;
+    Tcl_Obj *res, **arr = (Tcl_Obj **) ckalloc(num * sizeof(Tcl_Obj *));
     exmo aux;
-    for (i=0;i<len;i++) {
-        PLgetExmo((polyType *) PTR1(obj),PTR2(obj),&aux,i);
+    for (i=0;i<num;i++) {
+        PLgetExmo((polyType *) PTR1(obj),PTR2(obj),&aux,first+i);
         arr[i] = Tcl_NewExmoCopyObj(&aux);
     }
-    res = Tcl_NewListObj(len,arr);
+    res = Tcl_NewListObj(num,arr);
     ckfree((char *) arr);
     return res;
 }
 
+Tcl_Obj *Tcl_NewListFromPoly(Tcl_Obj *obj) {
+    int len = PLgetNumsum((polyType *) PTR1(obj),PTR2(obj));
+    return Tcl_NewListFromPolyRange(obj, 0, len);
+}
+
 /* free internal representation */
 void PolyFreeInternalRepProc(Tcl_Obj *obj) {
     DBGPOLY printf("PolyFreeInternalRepProc obj = %p\n",(void*)obj);
@@ -250,6 +255,38 @@ void PolyFreeInternalRepProc(Tcl_Obj *obj) {
     DBGPOLY printf("Leaving PolyFreeInternalRepProc\n");
 }
 
+/* decode the compact form "@poly <numsum> <data>" */
+static int PolySetFromCompact(Tcl_Interp *ip, Tcl_Obj *objPtr, Tcl_Obj **objv) {
+    int num, len, used, rcode;
+    unsigned char *data;
+    void *pol;
+    if (TCL_OK != Tcl_GetIntFromObj(ip, objv[1], &num))
+        return TCL_ERROR;
+    if (TCL_OK != compactStringData(ip, objv[2], &data, &len))
+        return TCL_ERROR;
+    if (NULL == (pol = (stdpoly->createCopy)(NULL))) {
+        freex(data);
+        RETERR("out of memory");
+    }
+    rcode = stdRealloc(pol, num);
+    if (SUCCESS == rcode)
+        rcode = binDecodePoly(stdpoly, pol, data, len, 1, 0, &used);
+    freex(data);
+    if (SUCCESS != rcode || used != len
+        || num != PLgetNumsum(stdpoly, pol)) {
+        (stdpoly->free)(pol);
+        RETERR("malformed compact polynomial");
+    }
+
+    TRYFREEOLDREP(objPtr);
+    PTR1(objPtr) = stdpoly;
+    PTR2(objPtr) = pol;
+    objPtr->typePtr = &tclPoly;
+    INCPOLCNT;
+
+    return TCL_OK;
+}
+
 /* try to turn objPtr into a Poly */
 int PolySetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     int objc, i;
@@ -258,8 +295,14 @@ int PolySetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
     DBGPOLY printf("PolySetFromAnyProc obj = %p\n",(void*)objPtr);
     if (TCL_OK != Tcl_ListObjGetElements(ip, objPtr, &objc, &objv))
         return TCL_ERROR;
+    if (3 == objc && isCompactTag(objv[0], "@poly"))
+        return PolySetFromCompact(ip, objPtr, objv);
     if (NULL == (pol = (stdpoly->createCopy)(NULL)))
         RETERR("out of memory");
+    if (SUCCESS != stdRealloc(pol, objc)) {
+        (stdpoly->free)(pol);
+        RETERR("out of memory");
+    }
     for (i=0;i<objc;i++) {
         if (TCL_OK != Tcl_ConvertToExmo(ip,objv[i])) {
             (stdpoly->free)(pol);
@@ -285,8 +328,26 @@ int PolySetFromAnyProc(Tcl_Interp *ip, Tcl_Obj *objPtr) {
 /* recreate string representation */
 void PolyUpdateStringProc(Tcl_Obj *objPtr) {
     Tcl_Obj *aux;
+    int num;
     DBGPOLY printf("PolyUpdateStringProc obj = %p\n",(void*)objPtr);
     LOGPOLY(objPtr);
+    num = PLgetNumsum((polyType *) PTR1(objPtr), PTR2(objPtr));
+    if (USECOMPACTSTRING(num)) {
+        unsigned char *data;
+        int len;
+        char header[50];
+        sprintf(header, "@poly %d", num);
+        if (SUCCESS == binEncodePoly((polyType *) PTR1(objPtr), PTR2(objPtr),
+                                     &data, &len)) {
+            setCompactStringRep(objPtr, header, data, len);
+            freex(data);
+        } else {
+            /* too large for a string, the list would be even longer;
+             * this panics */
+            setCompactStringRep(objPtr, header, NULL, 0);
+        }
+        return;
+    }
     aux = Tcl_NewListFromPoly(objPtr);
     copyStringRep(objPtr, aux);
     FREETCLOBJ(aux);
@@ -323,6 +384,8 @@ void Tcl_PolyObjConvert(Tcl_Obj *obj, polyType *newtype) {
 Tcl_Obj *Tcl_PolyObjCancel(Tcl_Obj *obj, int mod) {
     if (Tcl_IsShared(obj))
         obj = Tcl_DuplicateObj(obj);
+    if (NULL == ((polyType*)PTR1(obj))->cancel)
+        Tcl_PolyObjConvert(obj, stdpoly);
     PLcancel((polyType*)PTR1(obj),PTR2(obj),mod);
     Tcl_InvalidateStringRep(obj);
     return obj;
@@ -376,6 +439,9 @@ Tcl_Obj *Tcl_PolyObjAppend(Tcl_Obj *obj, Tcl_Obj *pol2, int scale, int mod) {
     if (Tcl_IsShared(obj))
         ASSERT(NULL == "obj must not be shared in Tcl_PolyObjAppend");
 
+    if (NULL == ((polyType*)PTR1(obj))->appendExmo)
+        Tcl_PolyObjConvert(obj, stdpoly);
+
     if (SUCCESS != PLappendPoly((polyType*)PTR1(obj),PTR2(obj),(polyType*)PTR1(pol2),PTR2(pol2),NULL,0,scale,mod))
         return NULL;
 
@@ -559,22 +625,63 @@ int Tcl_PolyForeachProc(Tcl_Interp *ip, Tcl_Obj *src,
  *   x < 0   : append this monomial to *res
  *   x >= 0  : append this monomial to "$(*objv[x])"
  *
- * If x is too big for the objv array the monomial is forgotten. */
+ * If x is too big for the objv array the monomial is forgotten.
+ *
+ * A destination that receives a contiguous range of *src (for example,
+ * all summands with the same generator of a sorted polynomial) becomes
+ * a slice of *src instead of a copy. For this the summands of *src are
+ * moved into a polyShare, and *src itself is turned into a slice. */
+
+/* make obj a slice, so that its summands can be shared */
+static polyShare *Tcl_PolyObjShare(Tcl_Obj *obj, int *offset) {
+    polyType *pt = polyTypeFromTclObj(obj);
+    polyShare *sh;
+    slice *v;
+
+    if (slicepoly == pt) {
+        v = (slice *) PTR2(obj);
+        *offset = v->start;
+        return v->share;
+    }
+
+    if (stdpoly != pt) return NULL;
+
+    if (NULL == (sh = shareCreate((stp *) PTR2(obj))))
+        return NULL;
+
+    if (NULL == (v = sliceCreate(sh, 0, ((stp *) PTR2(obj))->num))) {
+        freex(sh);
+        return NULL;
+    }
+
+    /* the value of obj does not change, so its string rep stays valid */
+    PTR1(obj) = slicepoly;
+    PTR2(obj) = v;
+
+    *offset = 0;
+    return sh;
+}
 
 int Tcl_PolySplitProc(Tcl_Interp *ip, int objc, Tcl_Obj *src, Tcl_Obj *proc,
                       Tcl_Obj * const objv[], Tcl_Obj **res) {
 
     polyType *pt; void *pdat;
-    int pns, idx, i, x;
+    int pns, idx, i, x, offset;
     exmo mono;
     Tcl_Obj **array;
     void **parray;
+    int *target, *first, *last, *count;
+    polyShare *sh = NULL;
     int rcode = SUCCESS, prc;
     Tcl_Obj *cmd[2];
 
     if (TCL_OK != Tcl_ConvertToPoly(ip, src))
         return TCL_ERROR;
 
+    pt   = polyTypeFromTclObj(src);
+    pdat = polyFromTclObj(src);
+    pns  = PLgetNumsum(pt, pdat);
+
     /* First create an array of empty polynomials. We let array[k+1]
      * correspond to objv[k] and array[0] to *res. */
 
@@ -586,14 +693,28 @@ int Tcl_PolySplitProc(Tcl_Interp *ip, int objc, Tcl_Obj *src, Tcl_Obj *proc,
         RETERR("out of memory");
     }
 
+    /* target[idx] is the destination of summand idx (or -1); for each
+     * destination we record its first and last summand and their number */
+
+    if (NULL == (target = (int *) mallox(sizeof(int) * (pns + 3 * (objc + 1))))) {
+        freex(array); freex(parray);
+        RETERR("out of memory");
+    }
+
+    first = target + pns;
+    last  = first + (objc + 1);
+    count = last + (objc + 1);
+
     array[0] = NULL; // just to silence a compiler warning
     for (i=0; i<(objc+1); i++) {
         if (NULL == (parray[i] = PLcreate(stdpoly))) {
             for (;i--;) DECREFCNT(array[i]);
-            freex(array); freex(parray);
+            freex(array); freex(parray); freex(target);
             RETERR("out of memory");
         }
         array[i] = Tcl_NewPolyObj(stdpoly, parray[i]);
+        first[i] = last[i] = -1;
+        count[i] = 0;
     }
 
     *res = array[0];
@@ -607,16 +728,14 @@ int Tcl_PolySplitProc(Tcl_Interp *ip, int objc, Tcl_Obj *src, Tcl_Obj *proc,
             for (;i<objc;i++)
                 DECREFCNT(array[i+1]);
             DECREFCNT(array[0]);
+            freex(array); freex(parray); freex(target);
             return TCL_ERROR;
         }
 
-
-    pt   = polyTypeFromTclObj(src);
-    pdat = polyFromTclObj(src);
-    pns  = PLgetNumsum(pt, pdat);
-
     cmd[0] = proc; cmd[1] = NULL;
 
+    for (idx=0; idx<pns; idx++) target[idx] = -1;
+
     for (idx=0; idx<pns; idx++) {
 
         if (SUCCESS != PLgetExmo(pt, pdat, &mono, idx)) {
@@ -664,14 +783,62 @@ int Tcl_PolySplitProc(Tcl_Interp *ip, int objc, Tcl_Obj *src, Tcl_Obj *proc,
             if (++x>objc) continue;
         } else x=0;
 
-        /* append to parray[x] */
+        /* remember that summand idx goes to parray[x] */
 
-        if (SUCCESS != PLappendExmo(stdpoly, parray[x], &mono)) {
-            Tcl_SetResult(ip, "internal error in Tcl_PolySplitProc: "
-                          "PLappendExmo failed", TCL_STATIC);
-            rcode = TCL_ERROR;
-            goto leave;
+        target[idx] = x;
+        if (0 == count[x]++) first[x] = idx;
+        last[x] = idx;
+    }
+
+    /* Now fill the destinations. Note that the filter proc may have
+     * changed the source polynomial's internal representation. */
+
+    if (TCL_OK != Tcl_ConvertToPoly(ip, src)) {
+        rcode = TCL_ERROR;
+        goto leave;
+    }
+
+    pt   = polyTypeFromTclObj(src);
+    pdat = polyFromTclObj(src);
+
+    for (i=0; i<(objc+1); i++) {
+
+        if (0 == count[i]) continue;
+
+        if ((count[i] == (last[i] - first[i] + 1))
+            && (PLgetNumsum(pt, pdat) == pns)) {
+
+            slice *v;
+
+            if ((NULL == sh) && (NULL != (sh = Tcl_PolyObjShare(src, &offset)))) {
+                pt   = polyTypeFromTclObj(src);
+                pdat = polyFromTclObj(src);
+            }
+
+            if ((NULL != sh)
+                && (NULL != (v = sliceCreate(sh, offset + first[i], count[i])))) {
+                PLfree(stdpoly, parray[i]);
+                PTR1(array[i]) = slicepoly;
+                PTR2(array[i]) = v;
+                Tcl_InvalidateStringRep(array[i]);
+                continue;
+            }
         }
+
+        for (idx=first[i]; idx<=last[i]; idx++) {
+
+            if (target[idx] != i) continue;
+
+            if ((SUCCESS != PLgetExmo(pt, pdat, &mono, idx))
+                || (SUCCESS != PLappendExmo(stdpoly, parray[i], &mono))) {
+                Tcl_SetResult(ip, "internal error in Tcl_PolySplitProc: "
+                              "PLappendExmo failed", TCL_STATIC);
+                rcode = TCL_ERROR;
+                goto leave;
+            }
+        }
+
+        Tcl_InvalidateStringRep(array[i]);
     }
 
  leave:
@@ -679,6 +846,7 @@ int Tcl_PolySplitProc(Tcl_Interp *ip, int objc, Tcl_Obj *src, Tcl_Obj *proc,
 
     freex(array);
     freex(parray);
+    freex(target);
 
     if (SUCCESS != rcode)
         DECREFCNT(*res);
@@ -728,7 +896,8 @@ Tcl_Obj *TakePolyFromVar(Tcl_Interp *ip, Tcl_Obj *varname) {
 
 typedef struct {
     stcl_context *ctx;
-    stp *p;
+    exmo *dat;
+    int num;
     int idx;
     int rc;
     Tcl_Obj *lengthvar;
@@ -740,11 +909,11 @@ typedef struct {
 
 int Tcl_CLGenSplitPolyPostProc(ClientData data[], Tcl_Interp *ip, int result) {
     clgsplitcbdata *cb = (clgsplitcbdata *)data[0];
-    stp *p = cb->p;
-    //fprintf(stderr,"res=%d, cb->idx=%d, p->num=%d\n",result,cb->idx,p->num);
+    exmo *dat = cb->dat;
+    //fprintf(stderr,"res=%d, cb->idx=%d, cb->num=%d\n",result,cb->idx,cb->num);
     if(TCL_OK == result || TCL_CONTINUE == result) {
-        int i=cb->idx, start=i, gen = (i<p->num) ? p->dat[i].gen : -1;
-        for(; i<p->num && p->dat[++i].gen == gen;) ;
+        int i=cb->idx, start=i, gen = (i<cb->num) ? dat[i].gen : -1;
+        for(; i<cb->num && dat[++i].gen == gen;) ;
         //fprintf(stderr,"gen=%d start=%d ... i=%d\n",gen,start,i);
         result = TCL_OK;
         if(start < i) {
@@ -760,7 +929,7 @@ int Tcl_CLGenSplitPolyPostProc(ClientData data[], Tcl_Interp *ip, int result) {
                                         bufsz, NULL, &rc);
             if(CL_SUCCESS == rc && buf) {
                 cl_command_queue q = GetOrCreateCommandQueue(ip,cb->ctx,0);
-                rc = clEnqueueWriteBuffer(q,buf,0/*blocking*/,0/*offset*/,bufsz,&(p->dat[start]),0,NULL,&evt);
+                rc = clEnqueueWriteBuffer(q,buf,0/*blocking*/,0/*offset*/,bufsz,&(dat[start]),0,NULL,&evt);
             }
             if(CL_SUCCESS != rc) {
                 SetCLErrorCode(ip,rc);
@@ -786,9 +955,9 @@ int Tcl_CLGenSplitPolyPostProc(ClientData data[], Tcl_Interp *ip, int result) {
 int Tcl_CLGenSplitPoly(Tcl_Interp *ip, Tcl_Obj *polyobj, Tcl_Obj *lengthvar, Tcl_Obj *genvar, Tcl_Obj *buf, Tcl_Obj *waitvar, Tcl_Obj *bdy) {
     stcl_context *ctx;
     if(TCL_OK != STcl_GetContext(ip, &ctx)) return TCL_ERROR;
-    polyType *pt = polyTypeFromTclObj(polyobj);
-    if(&stdPolyType != pt) {
-        Tcl_SetResult(ip, "wrong poly implementation; must be stdpoly", TCL_STATIC);
+    exmo *dat; int num;
+    if(SUCCESS != PLgetSummandArray(polyTypeFromTclObj(polyobj), polyFromTclObj(polyobj), &dat, &num)) {
+        Tcl_SetResult(ip, "wrong poly implementation; must be stdpoly or slice", TCL_STATIC);
         return TCL_ERROR;
     }
     clgsplitcbdata *cb = (clgsplitcbdata *)malloc(sizeof(clgsplitcbdata));
@@ -797,7 +966,8 @@ int Tcl_CLGenSplitPoly(Tcl_Interp *ip, Tcl_Obj *polyobj, Tcl_Obj *lengthvar, Tcl
         return TCL_ERROR;
     }
     cb->ctx = ctx;
-    cb->p = (stp*) polyFromTclObj(polyobj);
+    cb->dat = dat;
+    cb->num = num;
     cb->idx = 0;
     cb->lengthvar = lengthvar;
     cb->genvar = genvar;
@@ -1512,6 +1682,201 @@ int MonoCombiCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[])
 
 int Tpoly_HaveTypes = 0;
 
+/**** The "bin" format ************************************************************/
+
+/* steenrod::7bit encode <list of integers> */
+int SevenBitEncodeCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[]) {
+    Tcl_Obj **lst, *res;
+    long long *vals;
+    Tcl_WideInt w;
+    int i, len;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(ip, 1, objv, "<list of integers>");
+        return TCL_ERROR;
+    }
+
+    if (TCL_OK != Tcl_ListObjGetElements(ip, objv[1], &len, &lst))
+        return TCL_ERROR;
+
+    if (NULL == (vals = (long long *) mallox(sizeof(long long) * (len + 1))))
+        RETERR("out of memory");
+
+    for (i=0;i<len;i++) {
+        if (TCL_OK != Tcl_GetWideIntFromObj(ip, lst[i], &w)) {
+            freex(vals);
+            return TCL_ERROR;
+        }
+        vals[i] = w;
+    }
+
+    res = Tcl_NewByteArrayObj(NULL, 0);
+    Tcl_SetByteArrayLength(res, binEncodeInts(Tcl_SetByteArrayLength(res, 10 * len),
+                                              vals, len));
+    freex(vals);
+
+    Tcl_SetObjResult(ip, res);
+    return TCL_OK;
+}
+
+/* steenrod::7bit decode <data> */
+int SevenBitDecodeCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[]) {
+    const unsigned char *dat, *end;
+    Tcl_Obj *res;
+    long long val;
+    int len;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(ip, 1, objv, "<data>");
+        return TCL_ERROR;
+    }
+
+    dat = Tcl_GetByteArrayFromObj(objv[1], &len);
+    end = dat + len;
+
+    res = Tcl_NewListObj(0, NULL);
+    while (dat < end) {
+        if (SUCCESS != binDecodeInt(&dat, end, &val)) {
+            DECREFCNT(res);
+            RETERR("malformed 7bit data");
+        }
+        Tcl_ListObjAppendElement(ip, res, Tcl_NewWideIntObj(val));
+    }
+
+    Tcl_SetObjResult(ip, res);
+    return TCL_OK;
+}
+
+/* steenrod::binfmt encode <polynomial> */
+int BinfmtEncodeCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[]) {
+    unsigned char *buf;
+    int len;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(ip, 1, objv, "<polynomial>");
+        return TCL_ERROR;
+    }
+
+    if (TCL_OK != Tcl_ConvertToPoly(ip, objv[1]))
+        return TCL_ERROR;
+
+    if (SUCCESS != binEncodePoly(polyTypeFromTclObj(objv[1]),
+                                 polyFromTclObj(objv[1]), &buf, &len))
+        RETERR("binEncodePoly failed");
+
+    /* the result is a pure byte array, so sqlite stores it as a blob */
+    Tcl_SetObjResult(ip, Tcl_NewByteArrayObj(buf, len));
+    freex(buf);
+    return TCL_OK;
+}
+
+/* Decode the summands of data into a new stdpoly. If partial is set an
+ * incomplete summand at the end is left alone and the number of bytes
+ * that were used is returned in *used; otherwise all of data must be
+ * consumed. */
+static void *BinfmtDecodeData(Tcl_Interp *ip, Tcl_Obj *data, int scale,
+                              int modulo, int partial, int *used) {
+    const unsigned char *dat;
+    int len, cnt, rcode;
+    void *res;
+
+    dat = Tcl_GetByteArrayFromObj(data, &len);
+
+    if (NULL == (res = PLcreate(stdpoly))) {
+        Tcl_SetResult(ip, (char *) "out of memory", TCL_STATIC);
+        return NULL;
+    }
+
+    if (FAILOVERFLOW == (rcode = binDecodePoly(stdpoly, res, dat, len,
+                                               scale, modulo, &cnt))) {
+        PLfree(stdpoly, res);
+        Tcl_SetResult(ip, (char *) "coefficient overflow", TCL_STATIC);
+        return NULL;
+    }
+
+    if ((SUCCESS != rcode) || (!partial && (cnt != len))) {
+        PLfree(stdpoly, res);
+        Tcl_SetResult(ip, (char *) "malformed binary polynomial", TCL_STATIC);
+        return NULL;
+    }
+
+    if (NULL != used) *used = cnt;
+    return res;
+}
+
+/* steenrod::binfmt decode <data> */
+int BinfmtDecodeCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[]) {
+    void *res;
+
+    if (objc != 2) {
+        Tcl_WrongNumArgs(ip, 1, objv, "<data>");
+        return TCL_ERROR;
+    }
+
+    if (NULL == (res = BinfmtDecodeData(ip, objv[1], 1, 0, 0, NULL)))
+        return TCL_ERROR;
+
+    Tcl_SetObjResult(ip, Tcl_NewPolyObj(stdpoly, res));
+    return TCL_OK;
+}
+
+/* steenrod::binfmt vardecode <variable> <data> ?<scale>? ?<mod>?
+ *
+ * Appends the complete summands in data to the polynomial in variable
+ * and returns the number of bytes that were used. A summand that is cut
+ * off at the end of data is not decoded, so a stream can be processed
+ * chunk by chunk if the unused tail is prepended to the next chunk.
+ * The variable is left unchanged if data is malformed. */
+int BinfmtVarDecodeCmd(ClientData cd, Tcl_Interp *ip, int objc, Tcl_Obj *const objv[]) {
+    Tcl_Obj *pol;
+    void *aux;
+    int scale = 1, modval = 0, used, rcode;
+
+    if ((objc < 3) || (objc > 5)) {
+        Tcl_WrongNumArgs(ip, 1, objv, "<variable> <data> ?<scale>? ?<mod>?");
+        return TCL_ERROR;
+    }
+
+    if (objc > 3)
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[3], &scale))
+            return TCL_ERROR;
+
+    if (objc > 4)
+        if (TCL_OK != Tcl_GetIntFromObj(ip, objv[4], &modval))
+            return TCL_ERROR;
+
+    /* decode first, so that errors do not clobber the variable */
+    if (NULL == (aux = BinfmtDecodeData(ip, objv[2], scale, modval, 1, &used)))
+        return TCL_ERROR;
+
+    if (NULL == (pol = TakePolyFromVar(ip, objv[1]))) {
+        PLfree(stdpoly, aux);
+        return TCL_ERROR;
+    }
+
+    if (NULL == polyTypeFromTclObj(pol)->appendExmo)
+        Tcl_PolyObjConvert(pol, stdpoly);
+
+    Tcl_InvalidateStringRep(pol);
+
+    rcode = PLappendPoly(polyTypeFromTclObj(pol), polyFromTclObj(pol),
+                         stdpoly, aux, NULL, 0, 1, 0);
+    PLfree(stdpoly, aux);
+
+    if (NULL == Tcl_ObjSetVar2(ip, objv[1], NULL, pol, TCL_LEAVE_ERR_MSG)) {
+        DECREFCNT(pol);
+        return TCL_ERROR;
+    }
+
+    DECREFCNT(pol);
+
+    if (SUCCESS != rcode)
+        RETERR("out of memory");
+
+    Tcl_SetObjResult(ip, Tcl_NewIntObj(used));
+    return TCL_OK;
+}
+
 int Tpoly_Init(Tcl_Interp *ip) {
 
     Tcl_InitStubs(ip, "8.0", 0);
@@ -1544,6 +1909,15 @@ int Tpoly_Init(Tcl_Interp *ip) {
     Tcl_NRCreateCommand(ip, POLYNSP "poly", PolyCombiCmd, PolyNRECombiCmd, (ClientData) 0, NULL);
     Tcl_CreateObjCommand(ip, POLYNSP "mono", MonoCombiCmd, (ClientData) 0, NULL);
 
+    /* the ensembles themselves are set up in algebra.tc */
+    Tcl_Eval(ip, "namespace eval " POLYNSP "7bit {}");
+    Tcl_Eval(ip, "namespace eval " POLYNSP "binfmt {}");
+    Tcl_CreateObjCommand(ip, POLYNSP "7bit::encode", SevenBitEncodeCmd, (ClientData) 0, NULL);
+    Tcl_CreateObjCommand(ip, POLYNSP "7bit::decode", SevenBitDecodeCmd, (ClientData) 0, NULL);
+    Tcl_CreateObjCommand(ip, POLYNSP "binfmt::encode", BinfmtEncodeCmd, (ClientData) 0, NULL);
+    Tcl_CreateObjCommand(ip, POLYNSP "binfmt::decode", BinfmtDecodeCmd, (ClientData) 0, NULL);
+    Tcl_CreateObjCommand(ip, POLYNSP "binfmt::vardecode", BinfmtVarDecodeCmd, (ClientData) 0, NULL);
+
     Tcl_LinkVar(ip, POLYNSP "_multCount", (char *) &multCount, TCL_LINK_INT);
 
     Tcl_UnlinkVar(ip, POLYNSP "_polCount");
@@ -30,6 +30,12 @@ void     *polyFromTclObj(Tcl_Obj *obj);
 
 Tcl_Obj *Tcl_NewPolyObj(polyType *tp, void *data);
 
+/* list of the summands first, ..., first + num - 1 of a polynomial */
+Tcl_Obj *Tcl_NewListFromPolyRange(Tcl_Obj *obj, int first, int num);
+
+/* change the implementation of an unshared polynomial object */
+void Tcl_PolyObjConvert(Tcl_Obj *obj, polyType *newtype);
+
 #if USEOPENCL
 int Tcl_CLMapPoly(Tcl_Interp *ip, Tcl_Obj *polyobj, Tcl_Obj *lengthvar, Tcl_Obj *redbuf, Tcl_Obj *extbuf, Tcl_Obj *genbuf, Tcl_Obj *coeffbuf, int readonly);
 #endif
@@ -413,6 +413,87 @@ void copyStringRep(Tcl_Obj *dest, Tcl_Obj *src) {
     dest->length = slen;
 }
 
+int thestrlimit = 0;
+
+static const char b64chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void setCompactStringRep(Tcl_Obj *dest, const char *header,
+                         const unsigned char *data, size_t len) {
+    size_t hlen = strlen(header), i;
+    char *wrk;
+
+    if ((NULL == data) || (len > COMPACTSTRINGMAX))
+        Tcl_Panic("max size for a Tcl value (%d bytes) exceeded", INT_MAX);
+
+    dest->length = (int) (hlen + 1 + 4 * ((len + 2) / 3));
+    dest->bytes = wrk = (char *) ckalloc(dest->length + 1);
+
+    memcpy(wrk, header, hlen);
+    wrk += hlen;
+    *wrk++ = ' ';
+
+    for (i = 0; i + 2 < len; i += 3) {
+        unsigned int x = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        *wrk++ = b64chars[(x >> 18) & 0x3f];
+        *wrk++ = b64chars[(x >> 12) & 0x3f];
+        *wrk++ = b64chars[(x >> 6) & 0x3f];
+        *wrk++ = b64chars[x & 0x3f];
+    }
+    if (i < len) {
+        unsigned int x = data[i] << 16;
+        if (i + 1 < len) x |= data[i + 1] << 8;
+        *wrk++ = b64chars[(x >> 18) & 0x3f];
+        *wrk++ = b64chars[(x >> 12) & 0x3f];
+        *wrk++ = (i + 1 < len) ? b64chars[(x >> 6) & 0x3f] : '=';
+        *wrk++ = '=';
+    }
+    *wrk = 0;
+}
+
+int isCompactTag(Tcl_Obj *obj, const char *tag) {
+    const char *str = Tcl_GetString(obj);
+    return ('@' == *str) && (0 == strcmp(str, tag));
+}
+
+static int b64value(unsigned char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if ('+' == c) return 62;
+    if ('/' == c) return 63;
+    return -1;
+}
+
+int compactStringData(Tcl_Interp *ip, Tcl_Obj *obj,
+                      unsigned char **res, int *len) {
+    int slen, i, bits = 0;
+    unsigned int acc = 0;
+    const unsigned char *str =
+        (const unsigned char *) Tcl_GetStringFromObj(obj, &slen);
+    unsigned char *wrk;
+
+    if (NULL == (*res = wrk = (unsigned char *) mallox(3 * (slen / 4) + 3)))
+        TCLRETERR(ip, "out of memory");
+
+    for (i = 0; i < slen && '=' != str[i]; i++) {
+        int v = b64value(str[i]);
+        if (v < 0) {
+            freex(*res);
+            TCLRETERR(ip, "malformed compact string");
+        }
+        acc = (acc << 6) | v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *wrk++ = (acc >> bits) & 0xff;
+        }
+    }
+
+    *len = wrk - *res;
+    return TCL_OK;
+}
+
 void printObj(const char *vname, Tcl_Obj *obj) {
     printf("Tcl_Obj (%s) at %p:\n",(NULL != vname) ? vname : "no name given", (void*)obj);
     printf("  refCount=%d, bytes=%p, length=%d, type=%p (%s)\n",
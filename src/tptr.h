@@ -16,6 +16,7 @@
 
 #include <tcl.h>
 #include <stdarg.h>
+#include <limits.h>
 
 #include "common.h"
 
@@ -112,6 +113,37 @@ if (TCL_OK!=TPtr_CheckArgs(ip,objc,objv,T1,T2,T3,T4,T5,T6,T7,TP_END)) return TCL
 
 void copyStringRep(Tcl_Obj *dest, Tcl_Obj *src);
 
+/* Compact string representations. Objects whose size (number of summands
+ * or matrix entries) exceeds thestrlimit are printed as a short list
+ *
+ *     @tag n1 n2 ... data
+ *
+ * where the ni describe the dimensions and data is a base64 encoded
+ * binary dump. Such strings can be converted back to the original
+ * object. thestrlimit is linked to steenrod::_strlimit; 0 disables
+ * the compact format. */
+
+extern int thestrlimit;
+
+#define USECOMPACTSTRING(size) ((thestrlimit > 0) && ((size) > thestrlimit))
+
+/* the largest amount of data whose base64 text still fits into a Tcl
+ * string, leaving some room for the header */
+#define COMPACTSTRINGMAX ((size_t) (INT_MAX - 100) / 4 * 3)
+
+/* If data is NULL or longer than COMPACTSTRINGMAX the object has no
+ * string representation; like Tcl itself we panic in that case. */
+void setCompactStringRep(Tcl_Obj *dest, const char *header,
+                         const unsigned char *data, size_t len);
+
+/* returns 1 if objv[0] is the given tag */
+int isCompactTag(Tcl_Obj *obj, const char *tag);
+
+/* decode the base64 data of a compact string; *res is allocated
+ * with mallox and must be freed by the caller */
+int compactStringData(Tcl_Interp *ip, Tcl_Obj *obj,
+                      unsigned char **res, int *len);
+
 /* a debug routine */
 void printObj(const char *vname, Tcl_Obj *obj);
 